@@ -197,8 +197,13 @@ int InitializeImpl() {
     return 1;
 }
 
-char* HandleRequestImpl(const char* req) {
-    auto request = json::parse(req);
+PluginResult HandleRequestImpl(const char* req, size_t) {
+    // exceptions cannot cross the plugin boundary: a request that cannot be read is a failure
+    try {
+        auto request = json::parse(req);
+    } catch (const std::exception&) {
+        return PluginResult {nullptr, 0, nullptr, nullptr};
+    }
     nlohmann::json response = json::object();
 
     // Generate a random index to select a message
@@ -211,15 +216,7 @@ char* HandleRequestImpl(const char* req) {
     contents.push_back(MCPBuilder::ResourceText(resources[0].uri, resources[0].mime, messages[distr(gen)]));
     response["contents"] = contents;
 
-    std::string result = response.dump();
-    char* buffer = new char[result.length() + 1];
-#ifdef _WIN32
-    strcpy_s(buffer, result.length() + 1, result.c_str());
-#else
-    strcpy(buffer, result.c_str());
-#endif
-
-    return buffer;
+    return PluginStringResult(response.dump());
 }
 
 void ShutdownImpl() {
@@ -239,14 +236,18 @@ static PluginAPI plugin = {
         GetVersionImpl,
         GetTypeImpl,
         InitializeImpl,
-        HandleRequestImpl,
+        nullptr,
         ShutdownImpl,
         nullptr,
         nullptr,
         nullptr,
         nullptr,
         GetResourceCountImpl,
-        GetResourceImpl
+        GetResourceImpl,
+        nullptr,
+        HandleRequestImpl,
+        nullptr,
+        nullptr
 };
 
 extern "C" PLUGIN_API PluginAPI* CreatePlugin() {
@@ -256,3 +257,11 @@ extern "C" PLUGIN_API PluginAPI* CreatePlugin() {
 extern "C" PLUGIN_API void DestroyPlugin(PluginAPI*) {
     // Nothing to clean up for this example
 }
+
+extern "C" PLUGIN_API int GetPluginABIVersion() {
+    return PLUGIN_ABI_VERSION;
+}
+
+extern "C" PLUGIN_API PluginConcurrency GetPluginConcurrency() {
+    return {PLUGIN_CONCURRENCY_REENTRANT, 0};
+}
@@ -49,9 +49,15 @@ int InitializeImpl() {
     return 1;
 }
 
-char* HandleRequestImpl(const char* req) {
-    auto request = json::parse(req);
-    auto language = request["params"]["arguments"]["language"].get<std::string>();
+PluginResult HandleRequestImpl(const char* req, size_t) {
+    // exceptions cannot cross the plugin boundary: a request that cannot be read is a failure
+    std::string language;
+    try {
+        auto request = json::parse(req);
+        language = request.at("params").at("arguments").at("language").get<std::string>();
+    } catch (const std::exception&) {
+        return PluginResult {nullptr, 0, nullptr, nullptr};
+    }
 
     nlohmann::json response = json::object();
     nlohmann::json messages = json::array();
@@ -64,15 +70,7 @@ char* HandleRequestImpl(const char* req) {
     response["description"] = "this is the code review prompt";
     response["messages"] = messages;
 
-    std::string result = response.dump();
-    char* buffer = new char[result.length() + 1];
-#ifdef _WIN32
-    strcpy_s(buffer, result.length() + 1, result.c_str());
-#else
-    strcpy(buffer, result.c_str());
-#endif
-
-    return buffer;
+    return PluginStringResult(response.dump());
 }
 
 void ShutdownImpl() {
@@ -92,13 +90,17 @@ static PluginAPI plugin = {
         GetVersionImpl,
         GetTypeImpl,
         InitializeImpl,
-        HandleRequestImpl,
+        nullptr,
         ShutdownImpl,
         nullptr,
         nullptr,
         GetPromptCountImpl,
         GetPromptImpl,
         nullptr,
+        nullptr,
+        nullptr,
+        HandleRequestImpl,
+        nullptr,
         nullptr
 };
 
@@ -109,3 +111,11 @@ extern "C" PLUGIN_API PluginAPI* CreatePlugin() {
 extern "C" PLUGIN_API void DestroyPlugin(PluginAPI*) {
     // Nothing to clean up for this example
 }
+
+extern "C" PLUGIN_API int GetPluginABIVersion() {
+    return PLUGIN_ABI_VERSION;
+}
+
+extern "C" PLUGIN_API PluginConcurrency GetPluginConcurrency() {
+    return {PLUGIN_CONCURRENCY_REENTRANT, 0};
+}
@@ -66,35 +66,32 @@ int InitializeImpl() {
     return 1;
 }
 
-char* HandleRequestImpl(const char* req) {
-    auto request = json::parse(req);
+static PluginResult ErrorResult(const std::string& message) {
+    nlohmann::json errorResponse;
+    errorResponse["content"] = json::array();
+    errorResponse["content"].push_back(MCPBuilder::TextContent(message));
+    errorResponse["isError"] = true;
 
-    if (request["params"]["name"] == "logging_test") {
+    return PluginStringResult(errorResponse.dump());
+}
+
+static PluginResult RunTest(const json& request) {
+    const auto& params = request.at("params");
+
+    if (params.at("name") == "logging_test") {
         if (g_plugin) {
             std::string message = MCPBuilder::NotificationLog("notice","****** THIS IS A LOGGING TEST!").dump();
             g_plugin->notifications->SendToClient(GetNameImpl(), message.c_str());
             std::this_thread::sleep_for(std::chrono::seconds(1));
         }
-    } else if (request["params"]["name"] == "progress_test") {
+    } else if (params.at("name") == "progress_test") {
         // Total duration in seconds
         const int totalDuration = 10;
 
-        if (!request["params"].contains("_meta") || !request["params"]["_meta"].contains("progressToken")) {
-            nlohmann::json errorResponse;
-            errorResponse["content"] = json::array();
-            errorResponse["content"].push_back(MCPBuilder::TextContent("Missing required parameter: progressToken."));
-            errorResponse["isError"] = true;
-
-            std::string errorResult = errorResponse.dump();
-            char *errorBuffer = new char[errorResult.length() + 1];
-#ifdef _WIN32
-            strcpy_s(errorBuffer, errorResult.length() + 1, errorResult.c_str());
-#else
-            strcpy(errorBuffer, errorResult.c_str());
-#endif
-            return errorBuffer;
+        if (!params.contains("_meta") || !params.at("_meta").contains("progressToken")) {
+            return ErrorResult("Missing required parameter: progressToken.");
         }
-        std::string progressToken = request["params"]["_meta"]["progressToken"].get<std::string>();
+        std::string progressToken = params.at("_meta").at("progressToken").get<std::string>();
         
 
         if (g_plugin) {
@@ -122,15 +119,16 @@ char* HandleRequestImpl(const char* req) {
     response["content"].push_back(responseContent);
     response["isError"] = false;
 
-    std::string result = response.dump();
-    char* buffer = new char[result.length() + 1];
-#ifdef _WIN32
-    strcpy_s(buffer, result.length() + 1, result.c_str());
-#else
-    strcpy(buffer, result.c_str());
-#endif
+    return PluginStringResult(response.dump());
+}
 
-    return buffer;
+PluginResult HandleRequestImpl(const char* req, size_t) {
+    // exceptions cannot cross the plugin boundary: a request that cannot be read is an error result
+    try {
+        return RunTest(json::parse(req));
+    } catch (const std::exception& e) {
+        return ErrorResult(std::string("Invalid request: ") + e.what());
+    }
 }
 
 void ShutdownImpl() {
@@ -150,13 +148,17 @@ static PluginAPI plugin = {
         GetVersionImpl,
         GetTypeImpl,
         InitializeImpl,
-        HandleRequestImpl,
+        nullptr,
         ShutdownImpl,
         GetToolCountImpl,
         GetToolImpl,
         nullptr,
         nullptr,
         nullptr,
+        nullptr,
+        nullptr,
+        HandleRequestImpl,
+        nullptr,
         nullptr
 };
 
@@ -168,3 +170,13 @@ extern "C" PLUGIN_API PluginAPI* CreatePlugin() {
 extern "C" PLUGIN_API void DestroyPlugin(PluginAPI*) {
     // Nothing to clean up for this example
 }
+
+extern "C" PLUGIN_API int GetPluginABIVersion() {
+    return PLUGIN_ABI_VERSION;
+}
+
+extern "C" PLUGIN_API PluginConcurrency GetPluginConcurrency() {
+    // g_plugin and its notifications are set up before the first call and only read by the
+    // handler, and the host serializes SendToClient itself: calls do not need to wait for each other
+    return {PLUGIN_CONCURRENCY_REENTRANT, 0};
+}
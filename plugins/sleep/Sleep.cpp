@@ -22,7 +22,12 @@
 //  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //
 
+#include <map>
+#include <mutex>
 #include <thread>
+#include <chrono>
+#include <utility>
+#include <condition_variable>
 #include "PluginAPI.h"
 #include "json.hpp"
 
@@ -48,16 +53,9 @@ const char* GetNameImpl() { return "sleep-tools"; }
 const char* GetVersionImpl() { return "1.0.0"; }
 PluginType GetTypeImpl() { return PLUGIN_TYPE_TOOLS; }
 
-int InitializeImpl() {
-    return 1;
-}
-
-char* HandleRequestImpl(const char* req) {
-    auto request = json::parse(req);
-
-    auto milliseconds = request["params"]["arguments"]["milliseconds"].get<int>();
-    std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+using Clock = std::chrono::steady_clock;
 
+static PluginResult SleepResult(int milliseconds) {
     nlohmann::json responseContent;
     responseContent["type"] = "text";
     responseContent["text"] = "Waited for " + std::to_string(milliseconds) + " milliseconds";
@@ -67,18 +65,120 @@ char* HandleRequestImpl(const char* req) {
     response["content"].push_back(responseContent);
     response["isError"] = false;
 
-    std::string result = response.dump();
-    char* buffer = new char[result.length() + 1];
-#ifdef _WIN32
-    strcpy_s(buffer, result.length() + 1, result.c_str());
-#else
-    strcpy(buffer, result.c_str());
-#endif
+    return PluginStringResult(response.dump());
+}
+
+static PluginResult ErrorResult(const std::string& message) {
+    nlohmann::json errorContent;
+    errorContent["type"] = "text";
+    errorContent["text"] = message;
+
+    nlohmann::json response;
+    response["content"] = json::array();
+    response["content"].push_back(errorContent);
+    response["isError"] = true;
+
+    return PluginStringResult(response.dump());
+}
+
+// Sleeps waiting to be over, all of them completed by one thread: a sleeping request holds no
+// thread at all. Stopped by Shutdown, or when the library is unloaded without it.
+static struct Timer {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::multimap<Clock::time_point, std::pair<int, PluginCompletion*>> due;
+    std::thread thread;
+    bool running = false;
+
+    ~Timer() { Stop(); }
+
+    void Start() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) {
+            running = true;
+            thread = std::thread(&Timer::Loop, this);
+        }
+    }
+
+    bool Add(int milliseconds, PluginCompletion* completion) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) return false;
+        due.emplace(Clock::now() + std::chrono::milliseconds(milliseconds), std::make_pair(milliseconds, completion));
+        changed.notify_one();
+        return true;
+    }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        changed.notify_one();
+        if (thread.joinable()) {
+            thread.join();
+        }
+
+        // the sleeps still waiting are not going to end
+        for (auto& [deadline, sleep] : due) {
+            sleep.second->complete(sleep.second, PluginResult {nullptr, 0, nullptr, nullptr});
+        }
+        due.clear();
+    }
+
+    void Loop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (running) {
+            if (due.empty()) {
+                changed.wait(lock);
+                continue;
+            }
+            auto first = due.begin();
+            if (first->first > Clock::now()) {
+                changed.wait_until(lock, first->first);
+                continue;
+            }
+            auto [milliseconds, completion] = first->second;
+            due.erase(first);
+            lock.unlock();
+            completion->complete(completion, SleepResult(milliseconds));
+            lock.lock();
+        }
+    }
+} timer;
+
+int InitializeImpl() {
+    timer.Start();
+    return 1;
+}
+
+PluginResult HandleRequestImpl(const char* req, size_t) {
+    // exceptions cannot cross the plugin boundary: a request that cannot be read is an error result
+    int milliseconds = 0;
+    try {
+        auto request = json::parse(req);
+        milliseconds = request.at("params").at("arguments").at("milliseconds").get<int>();
+    } catch (const std::exception& e) {
+        return ErrorResult(std::string("Invalid sleep request: ") + e.what());
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+
+    return SleepResult(milliseconds);
+}
+
+int HandleRequestAsyncImpl(const char* req, size_t, PluginCompletion* completion) {
+    // exceptions cannot cross the plugin boundary: a request that cannot be read is refused
+    try {
+        auto request = json::parse(req);
 
-    return buffer;
+        auto milliseconds = request["params"]["arguments"]["milliseconds"].get<int>();
+        return timer.Add(milliseconds, completion) ? 1 : 0;
+    } catch (const std::exception&) {
+        return 0;
+    }
 }
 
 void ShutdownImpl() {
+    timer.Stop();
 }
 
 int GetToolCountImpl() {
@@ -95,14 +195,18 @@ static PluginAPI plugin = {
         GetVersionImpl,
         GetTypeImpl,
         InitializeImpl,
-        HandleRequestImpl,
+        nullptr,
         ShutdownImpl,
         GetToolCountImpl,
         GetToolImpl,
         nullptr,
         nullptr,
         nullptr,
-        nullptr
+        nullptr,
+        nullptr,
+        HandleRequestImpl,
+        nullptr,
+        HandleRequestAsyncImpl
 };
 
 extern "C" PLUGIN_API PluginAPI* CreatePlugin() {
@@ -112,3 +216,11 @@ extern "C" PLUGIN_API PluginAPI* CreatePlugin() {
 extern "C" PLUGIN_API void DestroyPlugin(PluginAPI*) {
     // Nothing to clean up for this example
 }
+
+extern "C" PLUGIN_API int GetPluginABIVersion() {
+    return PLUGIN_ABI_VERSION;
+}
+
+extern "C" PLUGIN_API PluginConcurrency GetPluginConcurrency() {
+    return {PLUGIN_CONCURRENCY_REENTRANT, 0};
+}
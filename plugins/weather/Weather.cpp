@@ -22,10 +22,17 @@
 //  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //
 
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <condition_variable>
 #include "PluginAPI.h"
 #include "json.hpp"
 #include "httplib.h"
 
+#define WEATHER_FETCH_THREADS 4
+
 using json = nlohmann::json;
 
 static PluginTool methods[] = {
@@ -50,17 +57,7 @@ const char* GetNameImpl() { return "weather-tools"; }
 const char* GetVersionImpl() { return "1.0.0"; }
 PluginType GetTypeImpl() { return PLUGIN_TYPE_TOOLS; }
 
-int InitializeImpl() {
-    return 1;
-}
-
-char* HandleRequestImpl(const char* req) {
-    auto request = json::parse(req);
-
-    auto latitude = request["params"]["arguments"]["latitude"].get<std::string>();
-    auto longitude = request["params"]["arguments"]["longitude"].get<std::string>();
-    auto city = request["params"]["arguments"]["city"].get<std::string>();
-
+static PluginResult Forecast(const std::string& latitude, const std::string& longitude, const std::string& city) {
     nlohmann::json weatherContent;
 
     httplib::Client cli("api.open-meteo.com");
@@ -69,9 +66,6 @@ char* HandleRequestImpl(const char* req) {
         // Parse the response from the weather API
         auto weatherData = json::parse(res->body);
 
-        // Extract city name from the request
-        auto city = request["params"]["arguments"]["city"].get<std::string>();
-
         // Create a human-readable message
         std::stringstream weatherMessage;
         weatherMessage << "Weather Forecast for " << city << ":\n\n";
@@ -171,18 +165,133 @@ char* HandleRequestImpl(const char* req) {
     response["content"].push_back(weatherContent);
     response["isError"] = false;
 
-    std::string result = response.dump();
-    char* buffer = new char[result.length() + 1];
-#ifdef _WIN32
-    strcpy_s(buffer, result.length() + 1, result.c_str());
-#else
-    strcpy(buffer, result.c_str());
-#endif
+    return PluginStringResult(response.dump());
+}
+
+static PluginResult ErrorResult(const std::string& message) {
+    nlohmann::json errorContent;
+    errorContent["type"] = "text";
+    errorContent["text"] = message;
+
+    nlohmann::json response;
+    response["content"] = json::array();
+    response["content"].push_back(errorContent);
+    response["isError"] = true;
+
+    return PluginStringResult(response.dump());
+}
+
+// Forecasts are fetched by a few threads of the plugin: the host threads do not wait on the
+// network. Stopped by Shutdown, or when the library is unloaded without it.
+static struct Fetcher {
+    struct Request {
+        std::string latitude;
+        std::string longitude;
+        std::string city;
+        PluginCompletion* completion;
+    };
+
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<Request> queue;
+    std::vector<std::thread> threads;
+    bool running = false;
+
+    ~Fetcher() { Stop(); }
+
+    void Start() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) {
+            running = true;
+            for (int i = 0; i < WEATHER_FETCH_THREADS; i++) {
+                threads.emplace_back(&Fetcher::Loop, this);
+            }
+        }
+    }
+
+    bool Add(Request request) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running) return false;
+            queue.push_back(std::move(request));
+        }
+        ready.notify_one();
+        return true;
+    }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        ready.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        threads.clear();
+    }
+
+    void Loop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            ready.wait(lock, [this] { return !running || !queue.empty(); });
+            if (queue.empty()) return; // stopped, nothing left to answer
+            Request request = std::move(queue.front());
+            queue.pop_front();
+            lock.unlock();
+            // nothing may escape this thread: a malformed reply from the weather API is an error result
+            PluginResult result {};
+            try {
+                result = Forecast(request.latitude, request.longitude, request.city);
+            } catch (const std::exception& e) {
+                result = ErrorResult("Cannot get weather forecast for " + request.city + ": " + e.what());
+            }
+            request.completion->complete(request.completion, result);
+            lock.lock();
+        }
+    }
+} fetcher;
+
+int InitializeImpl() {
+    fetcher.Start();
+    return 1;
+}
+
+PluginResult HandleRequestImpl(const char* req, size_t) {
+    // exceptions cannot cross the plugin boundary: a bad request, or a malformed reply from
+    // the weather API, is an error result
+    try {
+        auto request = json::parse(req);
 
-    return buffer;
+        auto latitude = request["params"]["arguments"]["latitude"].get<std::string>();
+        auto longitude = request["params"]["arguments"]["longitude"].get<std::string>();
+        auto city = request["params"]["arguments"]["city"].get<std::string>();
+
+        return Forecast(latitude, longitude, city);
+    } catch (const std::exception& e) {
+        return ErrorResult(std::string("Cannot get weather forecast: ") + e.what());
+    }
+}
+
+int HandleRequestAsyncImpl(const char* req, size_t, PluginCompletion* completion) {
+    // exceptions cannot cross the plugin boundary: a request that cannot be read is refused
+    try {
+        auto request = json::parse(req);
+
+        Fetcher::Request fetch {
+            request["params"]["arguments"]["latitude"].get<std::string>(),
+            request["params"]["arguments"]["longitude"].get<std::string>(),
+            request["params"]["arguments"]["city"].get<std::string>(),
+            completion
+        };
+        return fetcher.Add(std::move(fetch)) ? 1 : 0;
+    } catch (const std::exception&) {
+        return 0;
+    }
 }
 
 void ShutdownImpl() {
+    fetcher.Stop();
 }
 
 int GetToolCountImpl() {
@@ -199,14 +308,18 @@ static PluginAPI plugin = {
         GetVersionImpl,
         GetTypeImpl,
         InitializeImpl,
-        HandleRequestImpl,
+        nullptr,
         ShutdownImpl,
         GetToolCountImpl,
         GetToolImpl,
         nullptr,
         nullptr,
         nullptr,
-        nullptr
+        nullptr,
+        nullptr,
+        HandleRequestImpl,
+        nullptr,
+        HandleRequestAsyncImpl
 };
 
 extern "C" PLUGIN_API PluginAPI* CreatePlugin() {
@@ -216,3 +329,11 @@ extern "C" PLUGIN_API PluginAPI* CreatePlugin() {
 extern "C" PLUGIN_API void DestroyPlugin(PluginAPI*) {
     // Nothing to clean up for this example
 }
+
+extern "C" PLUGIN_API int GetPluginABIVersion() {
+    return PLUGIN_ABI_VERSION;
+}
+
+extern "C" PLUGIN_API PluginConcurrency GetPluginConcurrency() {
+    return {PLUGIN_CONCURRENCY_REENTRANT, 0};
+}
@@ -26,21 +26,61 @@
 #define MCP_SERVER_ITRANSPORT_H
 
 #include <string>
-#include <future>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <functional>
+#include "Message.h"
 
 namespace vx {
 
+    /// One outgoing message written in pieces as it is produced, see ITransport::OpenStream
+    class OutboundStream {
+    public:
+        virtual ~OutboundStream() = default;
+
+        /// Append to the message, blocking while the client is behind; false once it is gone
+        virtual bool Write(std::string_view data) = 0;
+        /// The message is complete
+        virtual void Close() = 0;
+        /// The message will never be complete: cut it off so the client cannot take it for a whole one
+        virtual void Abort() = 0;
+    };
+
     class ITransport {
     public:
+        virtual ~ITransport() = default;
+
         virtual bool Start() = 0;
         virtual void Stop() = 0;
         virtual bool IsRunning() = 0;
 
-        virtual std::pair<size_t, std::string> Read() = 0;
-        virtual void Write(const std::string& json_data) = 0;
+        virtual InboundMessage Read() = 0;
+        virtual void Write(const OutboundMessage& message) = 0;
+
+        // Write several messages at once. Transports override this to emit the
+        // whole batch with a single syscall / sink write. The batch is handed over:
+        // a transport may move the payloads out instead of copying them.
+        virtual void WriteBatch(std::vector<OutboundMessage>& messages) {
+            for (const auto& message : messages) {
+                Write(message);
+            }
+        }
+
+        // Run-to-completion: a transport supporting it answers a request by calling `handler`
+        // on the thread that received it, with no queue in between, and writes the returned
+        // response (empty for notifications) itself. Only messages `runs_inline` accepts are
+        // handled this way, the others (and those it cannot handle) still go through Read().
+        // Called before Start(); false if the transport does not support it.
+        using RequestHandler = std::function<std::string(const InboundMessage& message)>;
+        using InlineFilter = std::function<bool(const nlohmann::json& request)>;
+        virtual bool RunToCompletion(RequestHandler /*handler*/, InlineFilter /*runs_inline*/) { return false; }
 
-        virtual std::future<std::pair<size_t, std::string>> ReadAsync() = 0;
-        virtual std::future<void> WriteAsync(const std::string& json_data) = 0;
+        // Streamed response: the answer to request `id` of `session` is written in pieces, so a
+        // large result never sits in memory as a whole. The pieces carry no line breaks. Transports
+        // that cannot frame a message incrementally, or no longer have anybody waiting for it,
+        // return nullptr: the response then goes through Write() as usual.
+        virtual std::unique_ptr<OutboundStream> OpenStream(uint64_t /*session*/, const MessageId& /*id*/) { return nullptr; }
 
         virtual std::string GetName() = 0;
         virtual std::string GetVersion() = 0;
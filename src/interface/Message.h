@@ -0,0 +1,127 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef MCP_SERVER_MESSAGE_H
+#define MCP_SERVER_MESSAGE_H
+
+#include <string>
+#include <cstdint>
+#include <optional>
+#include <functional>
+#include "json.hpp"
+
+namespace vx {
+
+    /// JSON-RPC id kept in a form that can be compared and hashed without
+    /// formatting numbers as strings.
+    struct MessageId {
+        enum class Type : uint8_t { None, Number, String };
+
+        Type type = Type::None;
+        int64_t number = 0;
+        std::string text;
+
+        static MessageId From(const nlohmann::json& id) {
+            MessageId result;
+            if (id.is_number_integer()) {
+                result.type = Type::Number;
+                result.number = id.get<int64_t>();
+            } else if (id.is_string()) {
+                result.type = Type::String;
+                result.text = id.get<std::string>();
+            }
+            return result;
+        }
+
+        /// Id a transport can route on: the request id, or the first valid id of a batch
+        static MessageId Of(const nlohmann::json& message) {
+            if (message.is_object()) {
+                auto it = message.find("id");
+                return it != message.end() ? From(*it) : MessageId();
+            }
+            if (message.is_array()) {
+                for (const auto& element : message) {
+                    MessageId id = Of(element);
+                    if (id.Valid()) return id;
+                }
+            }
+            return {};
+        }
+
+        inline bool Valid() const { return type != Type::None; }
+
+        bool operator==(const MessageId& other) const {
+            if (type != other.type) return false;
+            if (type == Type::Number) return number == other.number;
+            return type == Type::None || text == other.text;
+        }
+
+        std::string ToString() const {
+            return type == Type::Number ? std::to_string(number) : text;
+        }
+    };
+
+    struct MessageIdHash {
+        size_t operator()(const MessageId& id) const {
+            return id.type == MessageId::Type::String ? std::hash<std::string>()(id.text)
+                                                      : std::hash<int64_t>()(id.number);
+        }
+    };
+
+    /// A serialized message leaving the server, with the routing information
+    /// the transports need so they never have to parse it back.
+    struct OutboundMessage {
+        enum class Kind : uint8_t { Response, Notification, Request };
+
+        Kind kind = Kind::Notification;
+        MessageId id;           // id of the response (first id for a batch reply), or of the request a notification relates to
+        std::string payload;    // serialized JSON-RPC message
+        uint64_t session = 0;   // session of the request being answered, 0 = every session
+
+        OutboundMessage() = default;
+        OutboundMessage(Kind k, MessageId i, std::string data, uint64_t s = 0)
+            : kind(k), id(std::move(i)), payload(std::move(data)), session(s) {}
+    };
+
+    /// A message received by a transport.
+    /// `raw` keeps the bytes as received; transports that already had to parse the
+    /// message (e.g. to inspect method and id) hand over the DOM in `parsed` so
+    /// the server does not parse the same bytes twice.
+    struct InboundMessage {
+        std::string raw;
+        std::optional<nlohmann::json> parsed;
+        uint64_t session = 0;   // transport session token, echoed in the OutboundMessage answering it
+
+        InboundMessage() = default;
+        explicit InboundMessage(std::string data) : raw(std::move(data)) {}
+        InboundMessage(std::string data, nlohmann::json dom, uint64_t s = 0)
+            : raw(std::move(data)), parsed(std::move(dom)), session(s) {}
+
+        // An empty message means the transport has been closed
+        inline bool Empty() const { return raw.empty(); }
+    };
+
+}
+
+#endif //MCP_SERVER_MESSAGE_H
@@ -31,6 +31,14 @@
 #define PLUGIN_API __attribute__((visibility("default")))
 #endif
 
+#include <stddef.h>
+
+// Version of the plugin ABI described here. A plugin tells the host which version it was
+// built for by exporting GetPluginABIVersion(); plugins that do not are version 1.
+// Versions only ever append members to PluginAPI, so a plugin built for version N can be
+// loaded by any host, which uses the members up to min(N, its own version).
+#define PLUGIN_ABI_VERSION 4
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -66,6 +74,49 @@ typedef struct {
     ClientNotificationCallback SendToClient;    // you should not touch this
 } NotificationSystem;
 
+// Result of a version 2 handler: `size` bytes at `data` (no NUL terminator needed), owned by
+// the plugin until the host is done with them and calls `release(owner)`, when not null.
+// The memory is freed by the code that allocated it, whatever allocator each side uses.
+typedef struct {
+    const char* data;
+    size_t size;
+    void* owner;
+    void (*release)(void* owner);
+} PluginResult;
+
+// Where a version 3 handler writes its result: call `write(context, data, size)` for each piece,
+// in order, before the handler returns. The pieces put together are the same JSON result a
+// version 2 handler would return; a tool result should set "isError" itself. `write` returns 0
+// once the client is gone: the handler can stop producing and return.
+typedef struct {
+    void* context;
+    int (*write)(void* context, const char* data, size_t size);
+} PluginWriter;
+
+// A request answered asynchronously (ABI version 4). The plugin calls `complete(completion, result)`
+// exactly once, from any thread, possibly before its handler has returned; the handle is gone
+// afterwards. Until then `notify(completion, notification)` sends a notification about the request
+// (e.g. progress) from any thread. `result` follows the PluginResult rules, null `data` is a failure.
+typedef struct PluginCompletion {
+    void* context;
+    void (*complete)(struct PluginCompletion* completion, PluginResult result);
+    void (*notify)(struct PluginCompletion* completion, const char* notification);
+} PluginCompletion;
+
+// How many calls a plugin takes at once, declared by exporting GetPluginConcurrency().
+// A call lasts until its handler returns or, for an asynchronous handler, until it completes.
+typedef enum {
+    PLUGIN_CONCURRENCY_SERIALIZED = 0,      // one call at a time, from any thread
+    PLUGIN_CONCURRENCY_REENTRANT = 1,       // any number of calls at once
+    PLUGIN_CONCURRENCY_LIMITED = 2,         // at most `limit` calls at once
+    PLUGIN_CONCURRENCY_THREAD_AFFINE = 3    // Initialize, Shutdown and the handlers always called from the same thread
+} PluginConcurrencyMode;
+
+typedef struct {
+    PluginConcurrencyMode mode;
+    int limit;  // PLUGIN_CONCURRENCY_LIMITED only
+} PluginConcurrency;
+
 typedef struct {
     const char* (*GetName)();
     const char* (*GetVersion)();
@@ -80,13 +131,44 @@ typedef struct {
     int (*GetResourceCount)();
     const PluginResource* (*GetResource)(int index);
     NotificationSystem* notifications;
+
+    // ABI version 2: takes precedence over HandleRequest when set. The request is NUL-terminated,
+    // `size` does not count the terminator. A result with null `data` means failure.
+    PluginResult (*HandleRequestV2)(const char* request, size_t size);
+
+    // ABI version 3: takes precedence over the other handlers when set. The result goes out
+    // through `writer` as it is produced instead of being held in memory as a whole.
+    // Returns 1 on success, 0 on failure (the host answers with an error if nothing was written).
+    int (*HandleRequestStream)(const char* request, size_t size, const PluginWriter* writer);
+
+    // ABI version 4: takes precedence over HandleRequestV2 and HandleRequest when set. The handler
+    // returns as soon as the work is under way and answers through `completion` (the request is
+    // only valid during the call: keep a copy). Returns 1 when the request was taken, 0 when it
+    // was refused, in which case `completion` must not be used.
+    int (*HandleRequestAsync)(const char* request, size_t size, PluginCompletion* completion);
 } PluginAPI;
 
 PLUGIN_API PluginAPI* CreatePlugin();
 PLUGIN_API void DestroyPlugin(PluginAPI*);
+PLUGIN_API int GetPluginABIVersion();   // optional, see PLUGIN_ABI_VERSION
+PLUGIN_API PluginConcurrency GetPluginConcurrency();   // optional, plugins without it are serialized
 
 #ifdef __cplusplus
 }
+
+#include <string>
+#include <utility>
+
+// Hand a std::string over to the host as a PluginResult without copying its content.
+// Both functions have internal linkage: the release always runs the plugin's own delete.
+static inline void PluginReleaseString(void* owner) {
+    delete static_cast<std::string*>(owner);
+}
+
+static inline PluginResult PluginStringResult(std::string&& text) {
+    auto* owner = new std::string(std::move(text));
+    return {owner->data(), owner->size(), owner, PluginReleaseString};
+}
 #endif
 
 #endif //MCP_SERVER_PLUGINAPI_H
@@ -0,0 +1,110 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "PluginGate.h"
+
+#include <future>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+namespace vx::mcp {
+
+    PluginGate::PluginGate(PluginConcurrency concurrency) : concurrency_(concurrency) {
+        switch (concurrency_.mode) {
+            case PLUGIN_CONCURRENCY_REENTRANT:
+                break;
+            case PLUGIN_CONCURRENCY_LIMITED:
+                concurrency_.limit = std::max(concurrency_.limit, 1);
+                limit_ = static_cast<size_t>(concurrency_.limit);
+                thread_ = std::make_unique<utils::ThreadPool>(limit_);
+                break;
+            case PLUGIN_CONCURRENCY_THREAD_AFFINE:
+                thread_ = std::make_unique<utils::ThreadPool>(1);
+                break;
+            default:
+                // unknown to this host: the safe choice
+                concurrency_ = {PLUGIN_CONCURRENCY_SERIALIZED, 1};
+                limit_ = 1;
+                thread_ = std::make_unique<utils::ThreadPool>(1);
+                break;
+        }
+    }
+
+    PluginGate::~PluginGate() {
+        if (thread_) thread_->Shutdown();
+    }
+
+    PluginGate::Slot PluginGate::Enter() {
+        if (limit_ == 0) {
+            return {};
+        }
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            freed_.wait(lock, [this]() { return busy_ < limit_; });
+            busy_++;
+        }
+        return Slot(this, [](PluginGate* gate) { gate->Leave(); });
+    }
+
+    void PluginGate::Leave() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            busy_--;
+        }
+        freed_.notify_one();
+    }
+
+    bool PluginGate::Post(std::function<void()> call) {
+        if (!thread_) {
+            call();
+            return true;
+        }
+        return thread_->Submit(std::move(call));
+    }
+
+    void PluginGate::Run(const std::function<void()>& call) {
+        if (!ThreadAffine() || thread_->InWorker()) {
+            call();
+            return;
+        }
+
+        std::packaged_task<void()> task(call);
+        auto done = task.get_future();
+        if (!thread_->Submit([&task]() { task(); })) {
+            throw std::runtime_error("plugin thread stopped");
+        }
+        done.get();
+    }
+
+    std::string PluginGate::Describe() const {
+        switch (concurrency_.mode) {
+            case PLUGIN_CONCURRENCY_REENTRANT: return "reentrant";
+            case PLUGIN_CONCURRENCY_LIMITED: return "limited to " + std::to_string(concurrency_.limit);
+            case PLUGIN_CONCURRENCY_THREAD_AFFINE: return "thread-affine";
+            default: return "serialized";
+        }
+    }
+
+}
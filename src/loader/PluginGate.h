@@ -0,0 +1,85 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef MCP_SERVER_PLUGIN_GATE_H
+#define MCP_SERVER_PLUGIN_GATE_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <functional>
+#include <condition_variable>
+#include "PluginAPI.h"
+#include "utils/ThreadPool.h"
+
+namespace vx::mcp {
+
+    /// Admission of the calls into one plugin, following the concurrency it declared (see
+    /// PluginConcurrency). Calls into a plugin that is not reentrant are queued to threads of
+    /// its own, as many as it takes calls at once (one for a thread-affine plugin), so a slow
+    /// plugin never holds the dispatch threads; a counting semaphore there keeps an asynchronous
+    /// call of a serialized or limited plugin counted until it completes.
+    class PluginGate {
+    public:
+        explicit PluginGate(PluginConcurrency concurrency);
+        ~PluginGate();
+
+        PluginGate(const PluginGate&) = delete;
+        PluginGate& operator=(const PluginGate&) = delete;
+
+        /// A call in progress: the slot frees up when the last copy goes away, so an asynchronous
+        /// call keeps it until it completes by holding a copy in its completion
+        using Slot = std::shared_ptr<void>;
+        /// Wait for a free slot; reentrant and thread-affine plugins never wait here
+        Slot Enter();
+
+        /// Queue `call` to the plugin's threads and return; false once they stopped.
+        /// Calls of a reentrant plugin, which has no threads, run right here.
+        bool Post(std::function<void()> call);
+
+        /// Run `call` on the plugin thread of a thread-affine plugin, waiting for it to be done
+        /// (exceptions are rethrown here); right here for the other plugins
+        void Run(const std::function<void()>& call);
+
+        /// Calls go through Post() rather than into the plugin on the caller's thread
+        bool Queued() const { return thread_ != nullptr; }
+        bool ThreadAffine() const { return concurrency_.mode == PLUGIN_CONCURRENCY_THREAD_AFFINE; }
+        PluginConcurrency Concurrency() const { return concurrency_; }
+        /// e.g. "serialized", "limited to 4"
+        std::string Describe() const;
+
+    private:
+        void Leave();
+
+        PluginConcurrency concurrency_;
+        size_t limit_ = 0;          // calls at once, 0 = no limit
+        size_t busy_ = 0;
+        std::mutex mutex_;
+        std::condition_variable freed_;
+        std::unique_ptr<utils::ThreadPool> thread_;    // all but reentrant plugins
+    };
+
+}
+
+#endif //MCP_SERVER_PLUGIN_GATE_H
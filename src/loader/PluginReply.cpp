@@ -0,0 +1,161 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "PluginReply.h"
+
+#include <cstring>
+#include <string>
+#include <memory>
+#include <utility>
+#include "aixlog.hpp"
+
+namespace vx::mcp {
+
+    namespace {
+        // The completion handle given to an asynchronous handler, alive until it completes
+        struct AsyncCall : PluginCompletion {
+            PluginReply::Completion onDone;
+            PluginReply::Notifier onNotify;
+        };
+    }
+
+    PluginReply::PluginReply(const PluginResult& result)
+        : data_(result.data), size_(result.data ? result.size : 0), owner_(result.owner), release_(result.release) {}
+
+    PluginReply::~PluginReply() {
+        Release();
+    }
+
+    PluginReply::PluginReply(PluginReply&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)),
+          owner_(std::exchange(other.owner_, nullptr)), release_(std::exchange(other.release_, nullptr)),
+          legacy_(std::exchange(other.legacy_, nullptr)) {}
+
+    PluginReply& PluginReply::operator=(PluginReply&& other) noexcept {
+        if (this != &other) {
+            Release();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            owner_ = std::exchange(other.owner_, nullptr);
+            release_ = std::exchange(other.release_, nullptr);
+            legacy_ = std::exchange(other.legacy_, nullptr);
+        }
+        return *this;
+    }
+
+    bool PluginReply::Streams(const RegistryEntry& entry) {
+        return entry.abiVersion >= 3 && entry.plugin->HandleRequestStream;
+    }
+
+    bool PluginReply::Stream(const RegistryEntry& entry, const nlohmann::json& request, std::string_view raw, const Sink& sink) {
+        std::string dumped;
+        if (raw.empty()) {
+            dumped = request.dump();
+            raw = dumped;
+        }
+
+        PluginWriter writer {const_cast<Sink*>(&sink), [](void* context, const char* data, size_t size) -> int {
+            try {
+                return (*static_cast<const Sink*>(context))({data, size}) ? 1 : 0;
+            } catch (...) {
+                return 0; // nothing may cross the plugin boundary
+            }
+        }};
+        return entry.plugin->HandleRequestStream(raw.data(), raw.size(), &writer) != 0;
+    }
+
+    bool PluginReply::Defers(const RegistryEntry& entry) {
+        return entry.abiVersion >= 4 && entry.plugin->HandleRequestAsync;
+    }
+
+    bool PluginReply::CallAsync(const RegistryEntry& entry, const nlohmann::json& request, std::string_view raw,
+                                Completion done, Notifier notify) {
+        std::string dumped;
+        if (raw.empty()) {
+            dumped = request.dump();
+            raw = dumped;
+        }
+
+        // owned here until the plugin takes it, then by the plugin until it calls complete
+        auto call = std::make_unique<AsyncCall>();
+        call->context = nullptr;
+        call->onDone = std::move(done);
+        call->onNotify = std::move(notify);
+        call->complete = [](PluginCompletion* completion, PluginResult result) {
+            std::unique_ptr<AsyncCall> call(static_cast<AsyncCall*>(completion));
+            PluginReply reply(result); // released even if nobody takes it
+            try {
+                call->onDone(std::move(reply));
+            } catch (const std::exception& e) {
+                LOG(ERROR) << "Completing plugin request failed: " << e.what() << std::endl;
+            }
+        };
+        call->notify = [](PluginCompletion* completion, const char* notification) {
+            auto* call = static_cast<AsyncCall*>(completion);
+            try {
+                if (call->onNotify) call->onNotify(notification);
+            } catch (const std::exception& e) {
+                LOG(ERROR) << "Plugin notification failed: " << e.what() << std::endl;
+            }
+        };
+
+        if (!entry.plugin->HandleRequestAsync(raw.data(), raw.size(), call.get())) {
+            return false;
+        }
+        call.release();
+        return true;
+    }
+
+    PluginReply PluginReply::Call(const RegistryEntry& entry, const nlohmann::json& request, std::string_view raw) {
+        std::string dumped;
+        if (raw.empty()) {
+            dumped = request.dump(); // e.g. a batch element: no bytes of its own
+            raw = dumped;
+        }
+
+        PluginReply reply;
+        if (entry.abiVersion >= 2 && entry.plugin->HandleRequestV2) {
+            reply = PluginReply(entry.plugin->HandleRequestV2(raw.data(), raw.size()));
+        } else if (entry.plugin->HandleRequest) {
+            reply.legacy_ = entry.plugin->HandleRequest(raw.data());
+            reply.data_ = reply.legacy_;
+            reply.size_ = reply.legacy_ ? std::strlen(reply.legacy_) : 0;
+        }
+        return reply;
+    }
+
+    void PluginReply::Release() {
+        if (release_) {
+            release_(owner_);
+        }
+        // --- Free the allocated memory ---
+        delete[] legacy_;
+        data_ = nullptr;
+        size_ = 0;
+        owner_ = nullptr;
+        release_ = nullptr;
+        legacy_ = nullptr;
+    }
+
+}
@@ -0,0 +1,88 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef MCP_SERVER_PLUGIN_REPLY_H
+#define MCP_SERVER_PLUGIN_REPLY_H
+
+#include <string_view>
+#include <functional>
+#include "json.hpp"
+#include "PluginAPI.h"
+#include "PluginsRegistry.h"
+
+namespace vx::mcp {
+
+    /// What a plugin handler returned. The bytes stay where the plugin put them and are
+    /// given back the way its ABI version says (release callback, or delete[] for version 1)
+    /// when the reply goes out of scope.
+    class PluginReply {
+    public:
+        PluginReply() = default;
+        /// Take over a version 2 result
+        explicit PluginReply(const PluginResult& result);
+        ~PluginReply();
+
+        PluginReply(const PluginReply&) = delete;
+        PluginReply& operator=(const PluginReply&) = delete;
+        PluginReply(PluginReply&& other) noexcept;
+        PluginReply& operator=(PluginReply&& other) noexcept;
+
+        /// Call the handler of `entry`, passing the request bytes as received when there are
+        /// some (transport buffers are NUL-terminated), its serialization otherwise
+        static PluginReply Call(const RegistryEntry& entry, const nlohmann::json& request, std::string_view raw);
+
+        /// The handler of `entry` writes its result in pieces (ABI version 3)
+        static bool Streams(const RegistryEntry& entry);
+        /// Call the streaming handler of `entry`, handing each piece of the result to `sink`, which
+        /// returns false when the pieces are no longer wanted. False if the plugin failed.
+        using Sink = std::function<bool(std::string_view data)>;
+        static bool Stream(const RegistryEntry& entry, const nlohmann::json& request, std::string_view raw, const Sink& sink);
+
+        /// The handler of `entry` answers later, from any thread (ABI version 4)
+        static bool Defers(const RegistryEntry& entry);
+        /// Call the asynchronous handler of `entry`. `done` gets the reply once, on the thread the
+        /// plugin completes on, maybe before CallAsync returns; `notify` gets the notifications the
+        /// plugin sends about the request until then. False if the plugin refused the request,
+        /// `done` is never called then.
+        using Completion = std::function<void(PluginReply reply)>;
+        using Notifier = std::function<void(const char* notification)>;
+        static bool CallAsync(const RegistryEntry& entry, const nlohmann::json& request, std::string_view raw,
+                              Completion done, Notifier notify);
+
+        bool Empty() const { return data_ == nullptr; }
+        std::string_view View() const { return {data_, size_}; }
+
+    private:
+        void Release();
+
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+        void* owner_ = nullptr;
+        void (*release_)(void*) = nullptr;
+        char* legacy_ = nullptr;    // version 1: allocated with new[] by the plugin
+    };
+
+}
+
+#endif //MCP_SERVER_PLUGIN_REPLY_H
@@ -52,9 +52,11 @@ namespace vx::mcp {
                     }
                 }
             }
+            RebuildRegistry();
             return true;
         } catch (const std::exception& ex) {
             LOG(ERROR) << "Error loading plugins: " << ex.what() << std::endl;
+            RebuildRegistry();
             return false;
         }
     }
@@ -85,6 +87,8 @@ namespace vx::mcp {
         // Get function pointers
         entry.createFunc = (PluginAPI * (*)())GetProcAddress(entry.handle, "CreatePlugin");
         entry.destroyFunc = (void (*)(PluginAPI *))GetProcAddress(entry.handle, "DestroyPlugin");
+        entry.abiVersionFunc = (int (*)())GetProcAddress(entry.handle, "GetPluginABIVersion");
+        entry.concurrencyFunc = (PluginConcurrency (*)())GetProcAddress(entry.handle, "GetPluginConcurrency");
 #else
         entry.handle = dlopen(path.c_str(), RTLD_LAZY);
         if (!entry.handle) {
@@ -95,6 +99,8 @@ namespace vx::mcp {
         // Get function pointers
         entry.createFunc = (PluginAPI * (*)())dlsym(entry.handle, "CreatePlugin");
         entry.destroyFunc = (void (*)(PluginAPI *))dlsym(entry.handle, "DestroyPlugin");
+        entry.abiVersionFunc = (int (*)())dlsym(entry.handle, "GetPluginABIVersion");
+        entry.concurrencyFunc = (PluginConcurrency (*)())dlsym(entry.handle, "GetPluginConcurrency");
 #endif
 
         // Check if required functions were found
@@ -110,11 +116,24 @@ namespace vx::mcp {
             return false;
         }
 
+        // Plugins without GetPluginABIVersion predate it: version 1. A newer plugin only
+        // appended members the host does not know about, it is used as the host's version.
+        entry.abiVersion = entry.abiVersionFunc ? std::clamp(entry.abiVersionFunc(), 1, PLUGIN_ABI_VERSION) : 1;
+
+        // The host cannot tell whether a plugin is reentrant: without a declaration it is serialized
+        PluginConcurrency concurrency {PLUGIN_CONCURRENCY_SERIALIZED, 1};
+        if (entry.concurrencyFunc) {
+            concurrency = entry.concurrencyFunc();
+        }
+        entry.gate = std::make_shared<PluginGate>(concurrency);
+
         // Create plugin instance
         entry.instance = entry.createFunc();
 
-        // Initialize the plugin
-        if (!entry.instance->Initialize()) {
+        // Initialize the plugin (on its own thread if it has one)
+        int initialized = 0;
+        entry.gate->Run([&entry, &initialized]() { initialized = entry.instance->Initialize(); });
+        if (!initialized) {
             LOG(ERROR) << "Plugin initialization failed: " << path << std::endl;
             entry.destroyFunc(entry.instance);
 
@@ -130,7 +149,8 @@ namespace vx::mcp {
         // Add to a plugin list
         m_plugins.push_back(entry);
         LOG(INFO) << "Loaded plugin: " << entry.instance->GetName()
-                  << " v" << entry.instance->GetVersion() << std::endl;
+                  << " v" << entry.instance->GetVersion() << " (ABI " << entry.abiVersion << ", "
+                  << entry.gate->Describe() << ")" << std::endl;
 
         return true;
     }
@@ -140,17 +160,19 @@ namespace vx::mcp {
             UnloadPlugin(entry);
         }
         m_plugins.clear();
+        RebuildRegistry();
     }
 
     void PluginsLoader::UnloadPlugin(PluginEntry& entry) {
         if (entry.instance) {
             // Shutdown the plugin
-            entry.instance->Shutdown();
+            entry.gate->Run([&entry]() { entry.instance->Shutdown(); });
 
             // Destroy the plugin instance
             entry.destroyFunc(entry.instance);
             entry.instance = nullptr;
         }
+        entry.gate.reset(); // joins the plugin thread, if any, while its code is still loaded
 
         // Unload the library
         if (entry.handle) {
@@ -167,4 +189,16 @@ namespace vx::mcp {
         return m_plugins;
     }
 
+    std::shared_ptr<const PluginsRegistry> PluginsLoader::GetRegistry() const {
+        return std::atomic_load(&m_registry);
+    }
+
+    void PluginsLoader::RebuildRegistry() {
+        auto registry = std::make_shared<const PluginsRegistry>(m_plugins);
+        LOG(INFO) << "Plugins registry: " << registry->Tools().size() << " tools, "
+                  << registry->Prompts().size() << " prompts, "
+                  << registry->Resources().size() << " resources" << std::endl;
+        std::atomic_store(&m_registry, std::shared_ptr<const PluginsRegistry>(std::move(registry)));
+    }
+
 }
\ No newline at end of file
@@ -41,6 +41,8 @@ typedef HMODULE LibraryHandle;
 
 #include "aixlog.hpp"
 #include "PluginAPI.h"
+#include "PluginsRegistry.h"
+#include "PluginGate.h"
 
 namespace vx::mcp {
 
@@ -48,10 +50,14 @@ namespace vx::mcp {
         std::string path;
         LibraryHandle handle;
         PluginAPI* instance;
+        int abiVersion;         // members of PluginAPI the host may use, see PLUGIN_ABI_VERSION
+        std::shared_ptr<PluginGate> gate;   // how calls are admitted, see PluginConcurrency
 
         // Function pointers
         PluginAPI* (*createFunc)();
         void (*destroyFunc)(PluginAPI*);
+        int (*abiVersionFunc)();    // optional
+        PluginConcurrency (*concurrencyFunc)();    // optional
     };
 
     class PluginsLoader {
@@ -68,12 +74,17 @@ namespace vx::mcp {
         // Get loaded plugins
         const std::vector<PluginEntry>& GetPlugins() const;
 
+        // Get the lookup tables of the loaded plugins (rebuilt whenever the plugin set changes)
+        std::shared_ptr<const PluginsRegistry> GetRegistry() const;
+
     private:
         bool LoadPlugin(const std::string& path);
         void UnloadPlugin(PluginEntry& entry);
+        void RebuildRegistry();
 
     private:
         std::vector<PluginEntry> m_plugins;
+        std::shared_ptr<const PluginsRegistry> m_registry;
     };
 
 }
@@ -0,0 +1,170 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "PluginsRegistry.h"
+#include "PluginsLoader.h"
+#include "aixlog.hpp"
+#include "json.hpp"
+
+namespace vx::mcp {
+
+    PluginsRegistry::PluginsRegistry(const std::vector<PluginEntry>& plugins) {
+        for (const auto& entry : plugins) {
+            PluginAPI* plugin = entry.instance;
+            if (!plugin) continue;
+
+            switch (plugin->GetType()) {
+                case PLUGIN_TYPE_TOOLS:
+                    for (int i = 0; plugin->GetToolCount && i < plugin->GetToolCount(); i++) {
+                        auto tool = plugin->GetTool(i);
+                        if (tool && tool->name && !tools_.Add({plugin, entry.abiVersion, entry.gate.get(), i, Intern(tool->name)})) {
+                            LOG(WARNING) << "Duplicate tool " << tool->name << " in plugin " << plugin->GetName() << " ignored." << std::endl;
+                        }
+                    }
+                    break;
+                case PLUGIN_TYPE_PROMPTS:
+                    for (int i = 0; plugin->GetPromptCount && i < plugin->GetPromptCount(); i++) {
+                        auto prompt = plugin->GetPrompt(i);
+                        if (prompt && prompt->name && !prompts_.Add({plugin, entry.abiVersion, entry.gate.get(), i, Intern(prompt->name)})) {
+                            LOG(WARNING) << "Duplicate prompt " << prompt->name << " in plugin " << plugin->GetName() << " ignored." << std::endl;
+                        }
+                    }
+                    break;
+                case PLUGIN_TYPE_RESOURCES:
+                    for (int i = 0; plugin->GetResourceCount && i < plugin->GetResourceCount(); i++) {
+                        auto resource = plugin->GetResource(i);
+                        if (resource && resource->uri && !resources_.Add({plugin, entry.abiVersion, entry.gate.get(), i, Intern(resource->uri)})) {
+                            LOG(WARNING) << "Duplicate resource " << resource->uri << " in plugin " << plugin->GetName() << " ignored." << std::endl;
+                        }
+                    }
+                    break;
+            }
+        }
+
+        tools_.Build();
+        prompts_.Build();
+        resources_.Build();
+
+        BuildListResults();
+    }
+
+    void PluginsRegistry::BuildListResults() {
+        // schemas and arguments are parsed here once instead of on every list request
+        auto parseOrEmpty = [](const char* text, const char* owner, nlohmann::ordered_json fallback) {
+            try {
+                return nlohmann::ordered_json::parse(text ? text : "");
+            } catch (const nlohmann::json::parse_error& e) {
+                LOG(ERROR) << "Invalid JSON declared by " << owner << ": " << e.what() << std::endl;
+                return fallback;
+            }
+        };
+
+        nlohmann::ordered_json tools = nlohmann::ordered_json::array();
+        for (const auto& entry : tools_.Entries()) {
+            auto pluginTool = entry.plugin->GetTool(entry.index);
+            nlohmann::ordered_json tool;
+            tool["name"] = pluginTool->name;
+            tool["description"] = pluginTool->description;
+            tool["inputSchema"] = parseOrEmpty(pluginTool->inputSchema, pluginTool->name, nlohmann::ordered_json::object());
+            tools.push_back(std::move(tool));
+        }
+        toolsListResult_ = nlohmann::ordered_json({{"tools", std::move(tools)}}).dump();
+
+        nlohmann::ordered_json prompts = nlohmann::ordered_json::array();
+        for (const auto& entry : prompts_.Entries()) {
+            auto pluginPrompt = entry.plugin->GetPrompt(entry.index);
+            nlohmann::ordered_json prompt;
+            prompt["name"] = pluginPrompt->name;
+            prompt["description"] = pluginPrompt->description;
+            prompt["arguments"] = parseOrEmpty(pluginPrompt->arguments, pluginPrompt->name, nlohmann::ordered_json::array());
+            prompts.push_back(std::move(prompt));
+        }
+        promptsListResult_ = nlohmann::ordered_json({{"prompts", std::move(prompts)}}).dump();
+
+        nlohmann::ordered_json resources = nlohmann::ordered_json::array();
+        for (const auto& entry : resources_.Entries()) {
+            auto pluginResource = entry.plugin->GetResource(entry.index);
+            nlohmann::ordered_json resource;
+            resource["name"] = pluginResource->name;
+            resource["description"] = pluginResource->description;
+            resource["uri"] = pluginResource->uri;
+            resource["mimeType"] = pluginResource->mime;
+            resources.push_back(std::move(resource));
+        }
+        resourcesListResult_ = nlohmann::ordered_json({{"resources", std::move(resources)}}).dump();
+    }
+
+    std::string_view PluginsRegistry::Intern(const char* value) {
+        return strings_.emplace_back(value);
+    }
+
+    bool PluginsRegistry::FlatIndex::Add(const RegistryEntry& entry) {
+        // first one wins, as the linear scan did
+        for (const auto& existing : entries_) {
+            if (existing.key == entry.key) return false;
+        }
+        entries_.push_back(entry);
+        return true;
+    }
+
+    void PluginsRegistry::FlatIndex::Build() {
+        // keep the load factor at or below 50% so probe sequences stay short
+        size_t size = 8;
+        while (size < entries_.size() * 2) size <<= 1;
+        mask_ = size - 1;
+        slots_.assign(size, Slot{});
+
+        for (size_t i = 0; i < entries_.size(); i++) {
+            uint64_t hash = Hash(entries_[i].key);
+            size_t pos = hash & mask_;
+            while (slots_[pos].entry != 0) {
+                pos = (pos + 1) & mask_;
+            }
+            slots_[pos] = {hash, static_cast<uint32_t>(i + 1)};
+        }
+    }
+
+    const RegistryEntry* PluginsRegistry::FlatIndex::Find(std::string_view key) const {
+        if (slots_.empty()) return nullptr;
+
+        uint64_t hash = Hash(key);
+        for (size_t pos = hash & mask_; slots_[pos].entry != 0; pos = (pos + 1) & mask_) {
+            if (slots_[pos].hash == hash) {
+                const RegistryEntry& entry = entries_[slots_[pos].entry - 1];
+                if (entry.key == key) return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    uint64_t PluginsRegistry::FlatIndex::Hash(std::string_view key) {
+        // FNV-1a
+        uint64_t hash = 14695981039346656037ull;
+        for (unsigned char c : key) {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+}
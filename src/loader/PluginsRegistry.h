@@ -0,0 +1,111 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef MCP_SERVER_PLUGINS_REGISTRY_H
+#define MCP_SERVER_PLUGINS_REGISTRY_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <cstdint>
+
+#include "PluginAPI.h"
+#include "PluginGate.h"
+
+namespace vx::mcp {
+
+    struct PluginEntry;
+
+    struct RegistryEntry {
+        PluginAPI* plugin;
+        int abiVersion;         // of the plugin, see PluginEntry
+        PluginGate* gate;       // of the plugin, alive as long as the plugin is loaded
+        int index;              // index to pass to GetTool / GetPrompt / GetResource
+        std::string_view key;   // interned tool name, prompt name or resource uri
+    };
+
+    /// Immutable lookup tables built once from the loaded plugins.
+    /// Tools, prompts and resources are indexed by name (uri for resources) in
+    /// open addressing hash tables, so a lookup is O(1) with no allocation and
+    /// no call across the plugin boundary.
+    class PluginsRegistry {
+    public:
+        explicit PluginsRegistry(const std::vector<PluginEntry>& plugins);
+
+        PluginsRegistry(const PluginsRegistry&) = delete;
+        PluginsRegistry& operator=(const PluginsRegistry&) = delete;
+
+        const RegistryEntry* FindTool(std::string_view name) const { return tools_.Find(name); }
+        const RegistryEntry* FindPrompt(std::string_view name) const { return prompts_.Find(name); }
+        const RegistryEntry* FindResource(std::string_view uri) const { return resources_.Find(uri); }
+
+        // Serialized "result" objects of tools/list, prompts/list and resources/list,
+        // built once per plugin set; callers only splice in the request id
+        const std::string& ToolsListResult() const { return toolsListResult_; }
+        const std::string& PromptsListResult() const { return promptsListResult_; }
+        const std::string& ResourcesListResult() const { return resourcesListResult_; }
+
+        // Entries in plugin load order
+        const std::vector<RegistryEntry>& Tools() const { return tools_.Entries(); }
+        const std::vector<RegistryEntry>& Prompts() const { return prompts_.Entries(); }
+        const std::vector<RegistryEntry>& Resources() const { return resources_.Entries(); }
+
+    private:
+        class FlatIndex {
+        public:
+            bool Add(const RegistryEntry& entry);
+            void Build();
+            const RegistryEntry* Find(std::string_view key) const;
+            const std::vector<RegistryEntry>& Entries() const { return entries_; }
+
+        private:
+            static uint64_t Hash(std::string_view key);
+
+            struct Slot {
+                uint64_t hash = 0;
+                uint32_t entry = 0;  // index into entries_ + 1, 0 means empty
+            };
+
+            std::vector<RegistryEntry> entries_;
+            std::vector<Slot> slots_;
+            size_t mask_ = 0;
+        };
+
+        std::string_view Intern(const char* value);
+        void BuildListResults();
+
+        std::deque<std::string> strings_;  // stable storage for the keys
+        FlatIndex tools_;
+        FlatIndex prompts_;
+        FlatIndex resources_;
+
+        std::string toolsListResult_;
+        std::string promptsListResult_;
+        std::string resourcesListResult_;
+    };
+
+}
+
+#endif //MCP_SERVER_PLUGINS_REGISTRY_H
@@ -23,7 +23,6 @@
 //
 
 #include "version.h"
-#include "httplib.h"
 #include "popl.hpp"
 #include "StdioTransport.h"
 #include "SseTransport.h"
@@ -31,9 +30,12 @@
 #include "server/Server.h"
 #include "aixlog.hpp"
 #include "loader/PluginsLoader.h"
+#include "loader/PluginReply.h"
 #include "json.hpp"
 #include "utils/MCPBuilder.h"
+#include "utils/ResultValidator.h"
 #include <csignal>
+#include <algorithm>
 
 using namespace popl;
 
@@ -62,12 +64,149 @@ void ClientNotificationCallbackImpl(const char* pluginName, const char* notifica
     }
 }
 
+/// Wrap a plugin result into a response without parsing it into a DOM.
+/// Tool results get "isError":false unless the plugin set it; empty if the result is malformed.
+/// The response is a single line for every transport: line breaks in the result (pretty-printed
+/// JSON) can only be whitespace between tokens, so they become spaces.
+std::string PluginResponse(const json& id, std::string_view result, bool toolResult) {
+    auto shape = vx::utils::ResultValidator::Scan(result);
+    if (!shape.valid) return {};
+    std::string response = toolResult && shape.object && !shape.hasIsError
+            ? MCPBuilder::RawResponse(id, result, R"("isError":false)", shape.empty)
+            : MCPBuilder::RawResponse(id, result);
+    if (shape.multiline) {
+        std::replace_if(response.begin(), response.end(), [](char c) { return c == '\n' || c == '\r'; }, ' ');
+    }
+    return response;
+}
+
+/// Response carrying the result a plugin replied with; a tool reply that cannot be used becomes an error result,
+/// a failed reply to anything else an error response
+std::string ReplyResponse(const json& id, const vx::mcp::PluginReply& reply, bool toolResult, const char* pluginName) {
+    if (reply.Empty()) {
+        LOG(ERROR) << "Plugin " << pluginName << " returned nullptr." << std::endl;
+        if (toolResult) {
+            return MCPBuilder::RawResponse(id,
+                R"({"isError":true,"content":[{"type":"text","text":"Plugin failed to handle the request."}]})");
+        }
+        return MCPBuilder::Error(MCPBuilder::InternalError, id, "Plugin failed to handle the request").dump();
+    }
+    std::string response = PluginResponse(id, reply.View(), toolResult);
+    if (response.empty()) {
+        LOG(ERROR) << "Plugin " << pluginName << " returned malformed data." << std::endl;
+        if (toolResult) {
+            return MCPBuilder::RawResponse(id,
+                R"({"isError":true,"content":[{"type":"text","text":"Plugin returned malformed data."}]})");
+        }
+        // TODO: how can we handle error here ?
+        return MCPBuilder::RawResponse(id, "{}");
+    }
+    return response;
+}
+
+/// Answer with a plugin writing its result in pieces (ABI version 3): they go straight to the
+/// client when the transport can take them that way. Empty when the response already went out.
+/// A plugin failing halfway never passes for a complete result: the client gets an error while
+/// none of it went out, a response cut off otherwise.
+std::string StreamPluginResponse(const vx::mcp::RegistryEntry& entry, const json& request, std::string_view raw, bool toolResult) {
+    auto stream = server->OpenResponseStream();
+    bool ok = vx::mcp::PluginReply::Stream(entry, request, raw, [&stream](std::string_view data) {
+        return stream.Write(data);
+    });
+    if (!ok) {
+        LOG(ERROR) << "Plugin " << entry.plugin->GetName() << " failed to handle " << request["method"] << std::endl;
+        if (toolResult) {
+            return stream.Abort(MCPBuilder::RawResponse(request["id"],
+                R"({"isError":true,"content":[{"type":"text","text":"Plugin failed to produce its result."}]})"));
+        }
+        return stream.Abort(MCPBuilder::Error(MCPBuilder::InternalError, request["id"], "Plugin failed to produce its result").dump());
+    }
+    if (!stream.Started()) {
+        return MCPBuilder::RawResponse(request["id"], "{}");
+    }
+    return stream.Close();
+}
+
+/// Answer with a plugin completing the request later (ABI version 4): the dispatch thread
+/// moves on as soon as the plugin took the request, `slot` is held until it completes.
+/// Empty when the response goes out by itself.
+std::string DeferredPluginResponse(const vx::mcp::RegistryEntry& entry, const json& request, std::string_view raw, bool toolResult,
+                                   const vx::mcp::PluginGate::Slot& slot) {
+    auto deferred = server->DeferResponse();
+    const char* pluginName = entry.plugin->GetName();
+    bool taken = false;
+    try {
+        taken = vx::mcp::PluginReply::CallAsync(entry, request, raw,
+            [deferred, id = request["id"], toolResult, pluginName, slot](vx::mcp::PluginReply reply) {
+                deferred.Complete(ReplyResponse(id, reply, toolResult, pluginName));
+            },
+            [deferred, pluginName](const char* notification) {
+                deferred.Notify(pluginName, notification);
+            });
+    } catch (...) {
+        deferred.Complete({}); // answered by the caller's error handling
+        throw;
+    }
+    if (!taken) {
+        LOG(ERROR) << "Plugin " << pluginName << " refused to handle " << request["method"] << std::endl;
+        deferred.Complete({});
+        return MCPBuilder::Error(MCPBuilder::InternalError, request["id"], "Plugin refused the request").dump();
+    }
+    return deferred.Await();
+}
+
+/// Call the handler of `entry` through the most capable entry point its ABI version offers,
+/// once the concurrency the plugin declared lets the call in
+std::string CallPlugin(const vx::mcp::RegistryEntry& entry, const json& request, std::string_view raw, bool toolResult) {
+    auto slot = entry.gate->Enter();
+    if (vx::mcp::PluginReply::Streams(entry)) {
+        return StreamPluginResponse(entry, request, raw, toolResult);
+    }
+    if (vx::mcp::PluginReply::Defers(entry)) {
+        return DeferredPluginResponse(entry, request, raw, toolResult, slot);
+    }
+    auto reply = vx::mcp::PluginReply::Call(entry, request, raw);
+    return ReplyResponse(request["id"], reply, toolResult, entry.plugin->GetName());
+}
+
+/// Answer with the plugin of `entry`. A plugin that is not reentrant takes its calls on threads
+/// of its own: the request is queued there and the dispatch thread moves on, a slow or busy
+/// plugin never holds the dispatch threads. Empty when the response goes out by itself.
+std::string PluginRequest(const vx::mcp::RegistryEntry& entry, const json& request, std::string_view raw, bool toolResult) {
+    if (!entry.gate->Queued()) {
+        return CallPlugin(entry, request, raw, toolResult);
+    }
+
+    // the call outlives the message it came with: it gets a copy of the request
+    auto deferred = server->DeferResponse();
+    auto queued = std::make_shared<const json>(request);
+    bool posted = entry.gate->Post(server->BindRequest([deferred, entry, queued, bytes = std::string(raw), toolResult]() {
+        const json& request = *queued;
+        try {
+            deferred.Complete(CallPlugin(entry, request, bytes, toolResult));
+        } catch (const std::exception& e) {
+            LOG(ERROR) << "Plugin " << entry.plugin->GetName() << " failed: " << e.what() << std::endl;
+            deferred.Complete(MCPBuilder::Error(MCPBuilder::InternalError, request["id"], e.what()).dump());
+        }
+    }, queued));
+    if (!posted) {
+        deferred.Complete({});
+        return MCPBuilder::Error(MCPBuilder::InternalError, request["id"], "Plugin stopped").dump();
+    }
+    return deferred.Await();
+}
+
 /// main entry point
 int main(int argc, char **argv) {
     std::string name;
     std::string plugins_directory;
     std::string logs_directory;
     bool verbose;
+    int workers;
+    int write_window;
+    int stdio_flush_delay;
+    int io_threads;
+    int replay_bytes;
 
     std::shared_ptr<vx::ITransport> transport;
     auto loader = std::make_shared<vx::mcp::PluginsLoader>();
@@ -87,12 +226,23 @@ int main(int argc, char **argv) {
     auto plugins_directory_option = op.add<Value<std::string>>("p", "plugins", "the directory where to load the plugins", "./plugins");
     auto logs_directory_option = op.add<Value<std::string>>("l", "logs", "the directory where to store the logs", "./logs");
     auto verbose_option = op.add<Value<bool>>("v", "verbose", "enable verbose", verbose);
+    auto workers_option = op.add<Value<int>>("w", "workers", "number of threads dispatching requests concurrently (0 = sequential)", DEFAULT_DISPATCH_WORKERS);
+    auto write_window_option = op.add<Value<int>>("", "write-window", "max microseconds an outgoing message waits to be coalesced with others", 0);
+    auto stdio_flush_delay_option = op.add<Value<int>>("", "stdio-flush-delay", "max microseconds stdio output stays buffered before being written (0 = immediately)", 0);
+    auto io_threads_option = op.add<Value<int>>("", "io-threads", "number of I/O threads of the sse/http stream server", HTTP_IO_THREADS);
+    auto replay_bytes_option = op.add<Value<int>>("", "replay-bytes", "bytes of recent events each sse/http stream session keeps for clients resuming with Last-Event-ID (0 = none)", SSE_REPLAY_BYTES);
+    auto run_to_completion_option = op.add<Switch>("", "run-to-completion", "answer http stream requests not handled by plugins on the I/O thread that received them");
     auto use_sse_server = op.add<Switch>("s", "sse", "start as sse server");
     auto use_httpstream_server = op.add<Switch>("t", "httpstream", "start as http stream server");
     name_option->assign_to(&name);
     plugins_directory_option->assign_to(&plugins_directory);
     logs_directory_option->assign_to(&logs_directory);
     verbose_option->assign_to(&verbose);
+    workers_option->assign_to(&workers);
+    write_window_option->assign_to(&write_window);
+    stdio_flush_delay_option->assign_to(&stdio_flush_delay);
+    io_threads_option->assign_to(&io_threads);
+    replay_bytes_option->assign_to(&replay_bytes);
 
     //============================================================================================
     // parse options
@@ -115,11 +265,13 @@ int main(int argc, char **argv) {
     // setup transport
     //============================================================================================
     if (use_sse_server->count() > 0) {
-        transport = std::make_shared<vx::transport::SSE>();
+        transport = std::make_shared<vx::transport::SSE>(8080, "127.0.0.1", io_threads, std::max(replay_bytes, 0));
     } else if (use_httpstream_server->count() > 0) {
-        transport = std::make_shared<vx::transport::HttpStream>();
+        transport = std::make_shared<vx::transport::HttpStream>(8080, "127.0.0.1", io_threads, std::max(replay_bytes, 0));
     } else {
-        transport = std::make_shared<vx::transport::Stdio>();
+        auto policy = stdio_flush_delay > 0 ? vx::transport::Stdio::FlushPolicy::Delayed
+                                            : vx::transport::Stdio::FlushPolicy::Immediate;
+        transport = std::make_shared<vx::transport::Stdio>(policy, std::chrono::microseconds(stdio_flush_delay));
     }
 
     //============================================================================================
@@ -169,153 +321,47 @@ int main(int argc, char **argv) {
     //============================================================================================
     server->Name(name);
     server->VerboseLevel(verbose ? 1 : 0);
-    server->OverrideCallback("tools/list", [&loader](const json& request) {
-        nlohmann::ordered_json response = MCPBuilder::Response(request);
-        response["result"]["tools"] = json::array();
-
-        for (const auto& plugin : loader->GetPlugins()) {
-            if (plugin.instance->GetType() == PLUGIN_TYPE_TOOLS) {
-                for (int i = 0; i < plugin.instance->GetToolCount(); i++) {
-                    nlohmann::ordered_json tool;
-                    auto pluginTool = plugin.instance->GetTool(i);
-                    tool["name"] = pluginTool->name;
-                    tool["description"] = pluginTool->description;
-                    tool["inputSchema"] = nlohmann::json::parse(pluginTool->inputSchema);
-                    response["result"]["tools"].push_back(tool);
-                }
-            }
-        }
-
-        return response;
+    server->Workers(workers);
+    server->WriteWindow(std::chrono::microseconds(write_window));
+    server->RunToCompletion(run_to_completion_option->count() > 0);
+    server->OverrideRawCallback("tools/list", [&loader](const json& request, std::string_view) {
+        return MCPBuilder::RawResponse(request["id"], loader->GetRegistry()->ToolsListResult());
     });
-    server->OverrideCallback("tools/call", [&loader](const json& request) {
-        nlohmann::ordered_json response = MCPBuilder::Response(request);
-
-        char* res_ptr = nullptr;
-
-        for (const auto& plugin : loader->GetPlugins()) {
-            if (plugin.instance->GetType() == PLUGIN_TYPE_TOOLS) {
-                for (int i = 0; i < plugin.instance->GetToolCount(); i++) {
-                    auto pluginTool = plugin.instance->GetTool(i);
-                    if (pluginTool->name == request["params"]["name"]) {
-                        res_ptr = plugin.instance->HandleRequest(request.dump().c_str());
-                        if (res_ptr) {
-                            try {
-                                response["result"] = json::parse(res_ptr);
-                                response["result"]["isError"] = false;
-                            } catch (const json::parse_error& e) {
-                                response["result"]["isError"] = true;
-                                response["result"]["content"] = json::array();
-                                response["result"]["content"].push_back({{"type", "text"}, {"text", "Plugin returned malformed data."}});
-                            }
-                            // --- Free the allocated memory ---
-                            delete[] res_ptr;
-                        } else {
-                            LOG(ERROR) << "Plugin " << pluginTool->name << " returned nullptr." << std::endl;
-                        }
-                        return response;
-                    }
-                }
-            }
+    server->OverrideRawCallback("tools/call", [&loader](const json& request, std::string_view raw) {
+        auto registry = loader->GetRegistry();
+        const auto& name = request["params"]["name"].get_ref<const std::string&>();
+        const auto* tool = registry->FindTool(name);
+        if (!tool) {
+            return MCPBuilder::Error(MCPBuilder::InvalidParams, request["id"], "Unknown tool: " + name).dump();
         }
 
-        return response;
+        return PluginRequest(*tool, request, raw, true);
     });
-    server->OverrideCallback("prompts/list", [&loader](const json& request) {
-        nlohmann::ordered_json response = MCPBuilder::Response(request);
-        response["result"]["prompts"] = json::array();
-
-        for (const auto& plugin : loader->GetPlugins()) {
-            if (plugin.instance->GetType() == PLUGIN_TYPE_PROMPTS) {
-                for (int i = 0; i < plugin.instance->GetPromptCount(); i++) {
-                    nlohmann::ordered_json prompt;
-                    auto pluginPrompt = plugin.instance->GetPrompt(i);
-                    prompt["name"] = pluginPrompt->name;
-                    prompt["description"] = pluginPrompt->description;
-                    prompt["arguments"] = nlohmann::json::parse(pluginPrompt->arguments);
-                    response["result"]["prompts"].push_back(prompt);
-                }
-            }
-        }
-
-        return response;
+    server->OverrideRawCallback("prompts/list", [&loader](const json& request, std::string_view) {
+        return MCPBuilder::RawResponse(request["id"], loader->GetRegistry()->PromptsListResult());
     });
-    server->OverrideCallback("prompts/get", [&loader](const json& request) {
-        nlohmann::ordered_json response = MCPBuilder::Response(request);
-
-        char* res_ptr = nullptr;
-
-        for (const auto& plugin : loader->GetPlugins()) {
-            if (plugin.instance->GetType() == PLUGIN_TYPE_PROMPTS) {
-                for (int i = 0; i < plugin.instance->GetPromptCount(); i++) {
-                    auto pluginPrompt = plugin.instance->GetPrompt(i);
-                    if (pluginPrompt->name == request["params"]["name"]) {
-                        res_ptr = plugin.instance->HandleRequest(request.dump().c_str());
-                        if (res_ptr) {
-                            try {
-                                response["result"] = json::parse(res_ptr);
-                            } catch (const json::parse_error& e) {
-                                LOG(ERROR) << "Plugin " << pluginPrompt->name << " returned malformed data." << std::endl;
-                                // TODO: how can we handle error here ?
-                            }
-                            // --- Free the allocated memory ---
-                            delete[] res_ptr;
-                        }
-                    }
-                    return response;
-                }
-            }
+    server->OverrideRawCallback("prompts/get", [&loader](const json& request, std::string_view raw) {
+        auto registry = loader->GetRegistry();
+        const auto& name = request["params"]["name"].get_ref<const std::string&>();
+        const auto* prompt = registry->FindPrompt(name);
+        if (!prompt) {
+            return MCPBuilder::Error(MCPBuilder::InvalidParams, request["id"], "Unknown prompt: " + name).dump();
         }
 
-        return response;
+        return PluginRequest(*prompt, request, raw, false);
     });
-    server->OverrideCallback("resources/list", [&loader](const json& request) {
-        nlohmann::ordered_json response = MCPBuilder::Response(request);
-        response["result"]["resources"] = json::array();
-
-        for (const auto& plugin : loader->GetPlugins()) {
-            if (plugin.instance->GetType() == PLUGIN_TYPE_RESOURCES) {
-                for (int i = 0; i < plugin.instance->GetResourceCount(); i++) {
-                    nlohmann::ordered_json resource;
-                    auto pluginResource = plugin.instance->GetResource(i);
-                    resource["name"] = pluginResource->name;
-                    resource["description"] = pluginResource->description;
-                    resource["uri"] = pluginResource->uri;
-                    resource["mimeType"] = pluginResource->mime;
-                    response["result"]["resources"].push_back(resource);
-                }
-            }
-        }
-
-        return response;
+    server->OverrideRawCallback("resources/list", [&loader](const json& request, std::string_view) {
+        return MCPBuilder::RawResponse(request["id"], loader->GetRegistry()->ResourcesListResult());
     });
-    server->OverrideCallback("resources/read", [&loader](const json& request) {
-        nlohmann::ordered_json response = MCPBuilder::Response(request);
-
-        char* res_ptr = nullptr;
-
-        for (const auto& plugin : loader->GetPlugins()) {
-            if (plugin.instance->GetType() == PLUGIN_TYPE_RESOURCES) {
-                for (int i = 0; i < plugin.instance->GetResourceCount(); i++) {
-                    auto pluginResource = plugin.instance->GetResource(i);
-                    if (pluginResource->uri == request["params"]["uri"]) {
-                        res_ptr = plugin.instance->HandleRequest(request.dump().c_str());
-                        if (res_ptr) {
-                            try {
-                                response["result"] = json::parse(res_ptr);
-                            } catch (const json::parse_error& e) {
-                                LOG(ERROR) << "Plugin " << pluginResource->name << " returned malformed data." << std::endl;
-                                // TODO: how can we handle error here ?
-                            }
-                            // --- Free the allocated memory ---
-                            delete[] res_ptr;
-                        }
-                    }
-                }
-            }
+    server->OverrideRawCallback("resources/read", [&loader](const json& request, std::string_view raw) {
+        auto registry = loader->GetRegistry();
+        const auto& uri = request["params"]["uri"].get_ref<const std::string&>();
+        const auto* resource = registry->FindResource(uri);
+        if (!resource) {
+            return MCPBuilder::Error(MCPBuilder::InvalidParams, request["id"], "Unknown resource: " + uri).dump();
         }
 
-        return response;
+        return PluginRequest(*resource, request, raw, false);
     });
 
     server->Connect(transport);
@@ -24,6 +24,7 @@
 
 #include <iostream>
 #include <utility>
+#include <algorithm>
 #include "Server.h"
 #include "aixlog.hpp"
 #include "version.h"
@@ -31,6 +32,25 @@
 
 namespace vx::mcp {
 
+    namespace {
+        // The request being handled by this thread: notifications a plugin sends while
+        // handling it (e.g. progress) are addressed to the session and request it belongs to
+        struct RequestContext {
+            uint64_t session = 0;
+            const json* request = nullptr;
+            bool standalone = false;    // a single request on a dispatch thread: its response may be
+                                        // written in pieces or later (OpenResponseStream, DeferResponse)
+        };
+        thread_local RequestContext currentRequest;
+
+        // Makes `context` the request of this thread for its lifetime
+        struct ScopedRequest {
+            RequestContext outer;
+            explicit ScopedRequest(RequestContext context) : outer(std::exchange(currentRequest, context)) {}
+            ~ScopedRequest() { currentRequest = outer; }
+        };
+    }
+
     Server::Server() {
         functionMap = {
                 {"initialize", [this](const json& req) { return this->InitializeCmd(req); }},
@@ -64,46 +84,56 @@ namespace vx::mcp {
 
     void Server::WriterLoop() {
         LOG(INFO) << "Writer thread started." << std::endl;
-        while (writer_running_.load()) {
-            std::string notification_to_send;
-            {
-                std::unique_lock<std::mutex> lock(output_mutex_);
-                // Wait until queue is not empty OR the writer should stop
-                queue_cv_.wait(lock, [this] { return !notification_queue_.empty() || !writer_running_.load(); });
-
-                // Check running flag again after waking up
-                if (!writer_running_.load() && notification_queue_.empty()) {
-                    break; // Exit loop if stopped and queue is empty
-                }
-
-                if (!notification_queue_.empty()) {
-                    notification_to_send = std::move(notification_queue_.front());
-                    notification_queue_.pop();
-                }
-            } // Release lock before potentially blocking write
+        std::vector<OutboundMessage> batch;
+        batch.reserve(MAX_WRITE_BATCH);
+        OutboundMessage message;
+        // WaitPop sleeps until a producer signals; it only fails once the queue is closed and drained
+        while (output_queue_.WaitPop(message)) {
+            batch.push_back(std::move(message));
+
+            // give bursts a bounded chance to pile up, then drain whatever is available
+            if (writeWindow_.count() > 0 && writer_running_.load()) {
+                std::this_thread::sleep_for(writeWindow_);
+            }
+            while (batch.size() < MAX_WRITE_BATCH && output_queue_.TryPop(message)) {
+                batch.push_back(std::move(message));
+            }
 
-            if (!notification_to_send.empty() && transport_) {
+            if (transport_) {
                 try {
-                    // Note: Write itself is not locked here, assuming transport handles internal sync
-                    // If transport->Write is not thread-safe, the lock needs to span this call too.
-                    // For stdio, writing from one thread should be okay, but locking provides safety.
-                    // Re-locking here for safety with potential other writes (responses).
-                    std::lock_guard<std::mutex> write_lock(output_mutex_);
-                    if (transport_) { // Check transport again after potential delay
-                        LOG(DEBUG) << "Sending Notification: " << notification_to_send << std::endl;
-                        transport_->Write(notification_to_send);
-                    }
+                    LOG(DEBUG) << "Sending " << batch.size() << " message(s)" << std::endl;
+                    transport_->WriteBatch(batch);
                 } catch (const std::exception& e) {
-                    LOG(ERROR) << "Error writing notification: " << e.what() << std::endl;
-                    // Decide how to handle write errors (e.g., log, ignore, stop?)
+                    LOG(ERROR) << "Error writing messages: " << e.what() << std::endl;
                 }
             }
-            // Small sleep to prevent tight loop if errors occur rapidly
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            batch.clear();
         }
         LOG(INFO) << "Writer thread stopped." << std::endl;
     }
 
+    void Server::InstallRunToCompletion() {
+        if (!runToCompletion_) return;
+
+        // single requests and notifications are answered by the transport thread that read them,
+        // skipping the reader, the dispatch pool and the writer; batches and the methods handled
+        // by plugins, which may block for as long as they like, still take the queues
+        bool supported = transport_->RunToCompletion([this](const InboundMessage& message) {
+            return ProcessRequest(*message.parsed, message.raw, message.session);
+        }, [](const json& request) {
+            if (!request.is_object()) return true;
+            auto method = request.find("method");
+            if (method == request.end() || !method->is_string()) return true;
+            const auto& name = method->get_ref<const std::string&>();
+            return name != "tools/call" && name != "prompts/get" && name != "resources/read";
+        });
+        if (supported) {
+            LOG(INFO) << "Run-to-completion dispatch enabled on " << transport_->GetName() << std::endl;
+        } else {
+            LOG(WARNING) << "Transport " << transport_->GetName() << " does not support run-to-completion dispatch." << std::endl;
+        }
+    }
+
     bool Server::Connect(const std::shared_ptr<ITransport> &transport) {
         if (!transport) {
             LOG(ERROR) << "Connect called with null transport." << std::endl;
@@ -114,9 +144,17 @@ namespace vx::mcp {
         isStopping_ = false; // Reset stopping flag
 
         // Start the writer thread
+        output_queue_.Reopen();
         writer_running_ = true;
         writer_thread_ = std::thread(&Server::WriterLoop, this);
 
+        // Start the dispatch workers
+        if (workers_ > 0) {
+            dispatch_pool_ = std::make_unique<utils::ThreadPool>(workers_);
+        }
+
+        InstallRunToCompletion();
+
         // Start transport (required for SSE; should be a no-op/true for stdio)
         if (!transport_->Start()) {
             LOG(ERROR) << "Failed to start transport: " << transport_->GetName() << std::endl;
@@ -124,31 +162,27 @@ namespace vx::mcp {
         }
 
         while (!isStopping_) {
-            auto [length, json_string] = transport->Read();
+            InboundMessage message = transport->Read();
             if (isStopping_) break;
 
-            if (length == 0 && json_string.empty()) {
+            if (message.Empty()) {
                 LOG(INFO) << "Read returned empty data, potentially client disconnected." << std::endl;
-                isStopping_ = true;
                 break;
             }
 
             try {
-                if (json_string.empty()) continue;
-                LOG(DEBUG) << "Received: " << json_string << std::endl;
-                json request = json::parse(json_string);
+                LOG(DEBUG) << "Received: " << message.raw << std::endl;
+                if (!message.parsed) message.parsed = json::parse(message.raw);
                 parserErrors_ = 0; // reset parser error
-                json response = HandleRequest(request);
-                if (response != nullptr) {
-                    std::lock_guard<std::mutex> lock(output_mutex_);
-                    LOG(DEBUG) << "Sending Response: " << response.dump() << std::endl;
-                    transport_->Write(response.dump());
-                }
+                Dispatch(std::move(message));
             } catch (json::parse_error &e) {
                 // ok... what should we do in this case ? exit process ? does nothing ?
                 // for now, we manage a max parser consecutive errors
                 LOG(ERROR) << "Error parsing JSON: " << e.what() << std::endl;
-                if (++parserErrors_ > MAX_PARSER_ERRORS) return false;
+                if (++parserErrors_ > MAX_PARSER_ERRORS) {
+                    Stop();
+                    return false;
+                }
             }
         }
 
@@ -167,47 +201,46 @@ namespace vx::mcp {
         isStopping_ = false;
 
         // Start the writer thread
+        output_queue_.Reopen();
         writer_running_ = true;
         writer_thread_ = std::thread(&Server::WriterLoop, this);
 
+        // Start the dispatch workers
+        if (workers_ > 0) {
+            dispatch_pool_ = std::make_unique<utils::ThreadPool>(workers_);
+        }
+
+        InstallRunToCompletion();
+
         // Start the async reader thread
         reader_running_ = true;
         reader_thread_ = std::thread([this]() {
             LOG(INFO) << "Async Reader thread started." << std::endl;
             while (reader_running_ && !isStopping_) {
                 try {
-                    auto future = transport_->ReadAsync();
-                    auto [length, json_string] = future.get();
+                    // this thread is already dedicated to reading: block in Read directly
+                    InboundMessage message = transport_->Read();
 
-                    if (isStopping_ || (length == 0 && json_string.empty())) {
+                    if (isStopping_ || message.Empty()) {
                         LOG(INFO) << "Empty message or stopping. Reader exiting.";
                         break;
                     }
 
-                    if (!json_string.empty()) {
-                        LOG(DEBUG) << "Received: " << json_string << std::endl;
-                        json request = json::parse(json_string);
-                        parserErrors_ = 0;
-
-                        json response = HandleRequest(request);
-                        if (response != nullptr) {
-                            std::lock_guard<std::mutex> lock(output_mutex_);
-                            LOG(DEBUG) << "Sending Response: " << response.dump() << std::endl;
-                            transport_->Write(response.dump());
-                        }
-                    }
+                    LOG(DEBUG) << "Received: " << message.raw << std::endl;
+                    if (!message.parsed) message.parsed = json::parse(message.raw);
+                    parserErrors_ = 0;
+                    Dispatch(std::move(message));
                 } catch (json::parse_error &e) {
                     LOG(ERROR) << "Error parsing JSON: " << e.what() << std::endl;
                     if (++parserErrors_ > MAX_PARSER_ERRORS) {
-                        isStopping_ = true;
+                        reader_running_ = false;
                         break;
                     }
                 } catch (const std::exception &e) {
                     LOG(ERROR) << "Reader thread exception: " << e.what() << std::endl;
-                    isStopping_ = true;
+                    reader_running_ = false;
                     break;
                 }
-                std::this_thread::sleep_for(std::chrono::milliseconds(1));
             }
             LOG(INFO) << "Async Reader thread exiting." << std::endl;
         });
@@ -216,26 +249,35 @@ namespace vx::mcp {
     }
 
     void Server::Stop() {
-        if (isStopping_) return; // Avoid redundant stopping
+        if (isStopping_.exchange(true)) return; // Avoid redundant stopping
 
-        // Stop transport (SSE shuts server down; stdio can no-op)
-        if (transport_) {
-            LOG(INFO) << "Stopping transport..." << std::endl;
-            transport_->Stop();
-            transport_.reset();
-            LOG(INFO) << "Transport stopped." << std::endl;
-         }
-
-        isStopping_ = true;
         LOG(INFO) << "Stopping server..." << std::endl;
 
+        // Let in-flight requests complete so their responses are still written
+        if (dispatch_pool_) {
+            dispatch_pool_->Shutdown();
+            LOG(INFO) << "Dispatch workers joined." << std::endl;
+        }
+
+        // Responses deferred to plugin threads are still on their way
+        AwaitDeferred();
+
         // Signal and join writer thread
         writer_running_ = false;
-        queue_cv_.notify_one(); // Wake up the writer thread if waiting
+        output_queue_.Close(); // Wake up the writer thread, it drains what is left
         if (writer_thread_.joinable()) {
             writer_thread_.join();
             LOG(INFO) << "Writer thread joined." << std::endl;
         }
+
+        // Stop transport (SSE shuts server down; stdio can no-op)
+        if (transport_) {
+            LOG(INFO) << "Stopping transport..." << std::endl;
+            transport_->Stop();
+            transport_.reset();
+            LOG(INFO) << "Transport stopped." << std::endl;
+        }
+
         LOG(INFO) << "Server stopped." << std::endl;
     }
 
@@ -245,15 +287,275 @@ namespace vx::mcp {
             return;
         }
 
-        // Add notification to the queue (protected by the mutex)
+        // sent while handling a request: it goes with that request, otherwise to every session
+        if (currentRequest.request) {
+            PushNotification(pluginName, notification, currentRequest.session, MessageId::Of(*currentRequest.request));
+        } else {
+            PushNotification(pluginName, notification, 0, {});
+        }
+    }
+
+    void Server::PushNotification(const std::string& pluginName, const char* notification, uint64_t session, MessageId id) {
+        if (!output_queue_.Push(OutboundMessage(OutboundMessage::Kind::Notification, std::move(id), notification, session))) {
+            LOG(WARNING) << pluginName << " notification dropped, output queue closed." << std::endl;
+        }
+    }
+
+    void Server::Dispatch(InboundMessage message) {
+        const json& request = *message.parsed;
+        if (request.is_array()) {
+            DispatchBatch(std::move(*message.parsed), message.session);
+            return;
+        }
+
+        // Notifications have no id and no reply: handle them on the reader
+        // thread so they are processed in the order they were received.
+        if (!dispatch_pool_ || !request.is_object() || !request.contains("id")) {
+            WriteResponse(message.session, MessageId::Of(request), ProcessRequest(request, message.raw, message.session, true));
+            return;
+        }
+
+        // the original bytes travel with the DOM, so plugins get them without a dump()
+        bool queued = dispatch_pool_->Submit([this, message = std::move(message)]() {
+            const json& request = *message.parsed;
+            WriteResponse(message.session, MessageId::Of(request), ProcessRequest(request, message.raw, message.session, true));
+        });
+        if (!queued) {
+            LOG(WARNING) << "Request dropped, server is stopping." << std::endl;
+        }
+    }
+
+    void Server::DispatchBatch(json batch, uint64_t session) {
+        if (batch.empty()) {
+            WriteResponse(session, {}, MCPBuilder::Error(MCPBuilder::InvalidRequest, json(nullptr), "Empty batch").dump());
+            return;
+        }
+
+        // one slot per element expecting a reply, so the reply array keeps the request order
+        struct BatchState {
+            json requests;
+            std::vector<std::string> responses;
+            std::atomic<size_t> remaining {0};
+            uint64_t session = 0;
+        };
+        auto state = std::make_shared<BatchState>();
+        state->requests = std::move(batch);
+        state->session = session;
+
+        std::vector<size_t> pending;
+        for (size_t i = 0; i < state->requests.size(); i++) {
+            const json& element = state->requests[i];
+            if (element.is_object() && !element.contains("id")) {
+                ProcessRequest(element, {}, state->session); // notification: in order, never answered
+            } else {
+                pending.push_back(i);
+            }
+        }
+        if (pending.empty()) return; // notifications only: no reply at all
+
+        state->responses.resize(pending.size());
+        state->remaining = pending.size();
+
+        auto complete = [this, state](size_t slot, size_t index) {
+            const json& element = state->requests[index];
+            std::string answer = ProcessRequest(element, {}, state->session);
+            if (answer.empty()) {
+                // every element carrying an id is answered, or the transport would wait for the batch forever
+                answer = MCPBuilder::Error(MCPBuilder::InternalError, element["id"], "No response").dump();
+            }
+            state->responses[slot] = std::move(answer);
+            if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::string reply = "[";
+                for (const auto& response : state->responses) {
+                    if (reply.size() > 1) reply.push_back(',');
+                    reply.append(response);
+                }
+                reply.push_back(']');
+                // routed like the batch itself: by the first element carrying an id
+                WriteResponse(state->session, MessageId::Of(state->requests), std::move(reply));
+            }
+        };
+
+        for (size_t slot = 0; slot < pending.size(); slot++) {
+            size_t index = pending[slot];
+            if (!dispatch_pool_ || !dispatch_pool_->Submit([complete, slot, index]() { complete(slot, index); })) {
+                complete(slot, index);
+            }
+        }
+    }
+
+    std::string Server::ProcessRequest(const json& request, std::string_view raw, uint64_t session, bool standalone) {
+        ScopedRequest scope(RequestContext{session, &request, standalone});
+
+        try {
+            return HandleRequest(request, raw);
+        } catch (const std::exception& e) {
+            LOG(ERROR) << "Error handling request: " << e.what() << std::endl;
+            if (!request.is_object()) {
+                return MCPBuilder::Error(MCPBuilder::InvalidRequest, json(nullptr), "Invalid request").dump();
+            } else if (auto id = request.find("id"); id != request.end()) {
+                return MCPBuilder::Error(MCPBuilder::InternalError, *id, e.what()).dump();
+            }
+        }
+        return {};
+    }
+
+    ResponseStream Server::OpenResponseStream() {
+        static const json none;
+        const json& request = currentRequest.request ? *currentRequest.request : none;
+        // a batch element is one piece of a bigger reply, and a run-to-completion request is
+        // handled on an I/O thread that must not wait for its own client
+        return ResponseStream(currentRequest.standalone ? transport_ : nullptr, currentRequest.session, request);
+    }
+
+    std::function<void()> Server::BindRequest(std::function<void()> work) {
+        return [context = currentRequest, work = std::move(work)]() {
+            ScopedRequest scope(context);
+            work();
+        };
+    }
+
+    std::function<void()> Server::BindRequest(std::function<void()> work, std::shared_ptr<const json> request) {
+        RequestContext context = currentRequest;
+        context.request = request.get();
+        return [context, request = std::move(request), work = std::move(work)]() {
+            ScopedRequest scope(context);
+            work();
+        };
+    }
+
+    DeferredResponse Server::DeferResponse() {
+        auto state = std::make_shared<DeferredResponse::State>();
+        state->server = this;
+        state->session = currentRequest.session;
+        // without dispatch workers requests are handled one after the other: wait for it inline
+        state->standalone = currentRequest.standalone && dispatch_pool_;
+        if (currentRequest.request) {
+            state->id = MessageId::Of(*currentRequest.request);
+        }
         {
-            std::lock_guard<std::mutex> lock(output_mutex_);
-            notification_queue_.emplace(notification);
+            std::lock_guard<std::mutex> lock(deferred_mutex_);
+            ++deferred_pending_;
+        }
+        return DeferredResponse(std::move(state));
+    }
+
+    void Server::DeferredCompleted() {
+        {
+            std::lock_guard<std::mutex> lock(deferred_mutex_);
+            --deferred_pending_;
+        }
+        deferred_cv_.notify_all();
+    }
+
+    void Server::AwaitDeferred() {
+        std::unique_lock<std::mutex> lock(deferred_mutex_);
+        if (deferred_pending_ == 0) return;
+        LOG(INFO) << "Waiting for " << deferred_pending_ << " deferred responses..." << std::endl;
+        if (!deferred_cv_.wait_for(lock, std::chrono::milliseconds(DEFERRED_DRAIN_TIMEOUT_MS),
+                                   [this]() { return deferred_pending_ == 0; })) {
+            LOG(WARNING) << deferred_pending_ << " deferred responses not completed, dropping them." << std::endl;
+        }
+    }
+
+    void DeferredResponse::Complete(std::string response) const {
+        std::unique_lock<std::mutex> lock(state_->mutex);
+        if (std::exchange(state_->done, true)) return;
+        if (state_->standalone) {
+            lock.unlock();
+            state_->server->WriteResponse(state_->session, state_->id, std::move(response));
+        } else {
+            state_->response = std::move(response);
+            lock.unlock();
+            state_->completed.notify_all();
+        }
+        state_->server->DeferredCompleted();
+    }
+
+    void DeferredResponse::Notify(const std::string& pluginName, const char* notification) const {
+        if (state_->server->isStopping_) {
+            LOG(WARNING) << pluginName << " attempted to send notification while server stopping." << std::endl;
+            return;
         }
-        queue_cv_.notify_one(); // Notify the writer thread
+        state_->server->PushNotification(pluginName, notification, state_->session, state_->id);
     }
 
-    json Server::HandleRequest(const json &request) {
+    std::string DeferredResponse::Await() const {
+        if (state_->standalone) return {};
+        std::unique_lock<std::mutex> lock(state_->mutex);
+        state_->completed.wait(lock, [this]() { return state_->done; });
+        return std::move(state_->response);
+    }
+
+    ResponseStream::ResponseStream(std::shared_ptr<ITransport> transport, uint64_t session, const json& request)
+        : transport_(std::move(transport)), session_(session), id_(MessageId::Of(request)) {
+        json id = request.is_object() && request.contains("id") ? request["id"] : json(nullptr);
+        head_.append(R"({"jsonrpc":"2.0","id":)").append(id.dump()).append(R"(,"result":)");
+    }
+
+    bool ResponseStream::Write(std::string_view data) {
+        if (closed_ || !open_) return false;
+        if (!started_) {
+            started_ = true;
+            if (transport_) stream_ = transport_->OpenStream(session_, id_);
+            buffer_ = std::move(head_);
+        }
+
+        // the response is a single line for every transport: line breaks can only be
+        // whitespace between JSON tokens (inside strings they are escaped), so they become spaces
+        size_t start = buffer_.size();
+        buffer_.append(data);
+        std::replace_if(buffer_.begin() + static_cast<std::ptrdiff_t>(start), buffer_.end(),
+                        [](char c) { return c == '\n' || c == '\r'; }, ' ');
+
+        if (stream_ && buffer_.size() >= RESPONSE_STREAM_CHUNK) {
+            open_ = stream_->Write(buffer_);
+            flushed_ = true;
+            buffer_.clear();
+        }
+        return open_;
+    }
+
+    std::string ResponseStream::Close() {
+        if (std::exchange(closed_, true) || !started_) return {};
+        buffer_.push_back('}');
+        if (!stream_) {
+            return std::move(buffer_);
+        }
+        if (!open_) {
+            stream_->Abort(); // the transport gave up on it halfway: never a complete response
+        } else {
+            stream_->Write(buffer_);
+            stream_->Close();
+        }
+        buffer_.clear();
+        return {};
+    }
+
+    std::string ResponseStream::Abort(std::string response) {
+        if (std::exchange(closed_, true)) return {};
+        buffer_.clear();
+        if (!stream_) return response;
+        if (flushed_ || response.empty()) {
+            stream_->Abort();
+        } else {
+            // the transport is already committed to this response, but none of the result was sent
+            if (open_) stream_->Write(response);
+            stream_->Close();
+        }
+        return {};
+    }
+
+    void Server::WriteResponse(uint64_t session, MessageId id, std::string response) {
+        if (response.empty()) return;
+
+        // responses carry the id of their request, so they can be written in completion order
+        if (!output_queue_.Push(OutboundMessage(OutboundMessage::Kind::Response, std::move(id), std::move(response), session))) {
+            LOG(WARNING) << "Response dropped, output queue closed." << std::endl;
+        }
+    }
+
+    std::string Server::HandleRequest(const json &request, std::string_view raw) {
         // log the request
         if (verboseLevel_ == 1) {
             LOG(DEBUG) << "=== Request START ===" << std::endl;
@@ -262,28 +564,44 @@ namespace vx::mcp {
         }
 
         // mandatory checks
-        if (!request.contains("method")) {
-            return MCPBuilder::Error(MCPBuilder::InvalidRequest, request["id"], "Missing method");
+        if (!request.is_object()) {
+            return MCPBuilder::Error(MCPBuilder::InvalidRequest, json(nullptr), "Invalid request").dump();
+        }
+        // a message without id is a notification, never answered, not even with an error
+        auto id = request.find("id");
+        bool notification = id == request.end();
+        auto method = request.find("method");
+        if (method == request.end() || !method->is_string()) {
+            if (notification) return {};
+            return MCPBuilder::Error(MCPBuilder::InvalidRequest, *id, "Missing method").dump();
+        }
+
+        // the handlers of requests answer by id: a request sent as a notification has nobody to answer
+        const auto& methodName = method->get_ref<const std::string&>();
+        if (notification && methodName.rfind("notifications/", 0) != 0) {
+            LOG(WARNING) << "Ignoring " << methodName << " sent without id" << std::endl;
+            return {};
         }
 
         // handle command
-        std::string methodName = request["method"];
-        auto it = functionMap.find(methodName);
-        if (it != functionMap.end()) {
-            json response = it->second(request);
-            if (response != nullptr) {
-                if (verboseLevel_ == 1) {
-                    LOG(DEBUG) << "=== Response START ===" << std::endl;
-                    LOG(DEBUG) << response.dump(4) << std::endl;
-                    LOG(DEBUG) << "=== Response END ===" << std::endl;
-                }
-            }
-            return response;
+        std::string response;
+        if (auto rawFunction = rawFunctionMap.find(methodName); rawFunction != rawFunctionMap.end()) {
+            response = rawFunction->second(request, raw);
+        } else if (auto it = functionMap.find(methodName); it != functionMap.end()) {
+            json result = it->second(request);
+            if (result != nullptr) response = result.dump();
+        } else {
+            // handle method not found case
+            if (notification) return {};
+            return MCPBuilder::Error(MCPBuilder::MethodNotFound, *id, "Method not found").dump();
         }
 
-        // handle method not found case
-        int id = request["id"];
-        return MCPBuilder::Error(MCPBuilder::MethodNotFound, std::to_string(id), "Method not found");
+        if (!response.empty() && verboseLevel_ == 1) {
+            LOG(DEBUG) << "=== Response START ===" << std::endl;
+            LOG(DEBUG) << response << std::endl;
+            LOG(DEBUG) << "=== Response END ===" << std::endl;
+        }
+        return response;
     }
 
     bool Server::OverrideCallback(const std::string &method, std::function<json(const json &)> function) {
@@ -294,6 +612,14 @@ namespace vx::mcp {
         return false;
     }
 
+    bool Server::OverrideRawCallback(const std::string &method, RawCallback function) {
+        if (functionMap.find(method) != functionMap.end()) {
+            rawFunctionMap[method] = std::move(function);
+            return true;
+        }
+        return false;
+    }
+
     json Server::InitializeCmd(const json &request) {
         LOG(INFO) << "InitializeCommand" << std::endl;
         if (request.contains("params")) {
@@ -494,14 +820,21 @@ namespace vx::mcp {
     }
 
     void Server::StopAsync() {
-        if (isStopping_) return;
+        if (isStopping_.exchange(true)) return;
 
-        isStopping_ = true;
         LOG(INFO) << "Stopping async server..." << std::endl;
 
+        if (dispatch_pool_) {
+            dispatch_pool_->Shutdown();
+            LOG(INFO) << "Dispatch workers joined." << std::endl;
+        }
+
+        // Responses deferred to plugin threads are still on their way
+        AwaitDeferred();
+
         // Stop writer thread
         writer_running_ = false;
-        queue_cv_.notify_one();
+        output_queue_.Close();
         if (writer_thread_.joinable()) {
             writer_thread_.join();
             LOG(INFO) << "Writer thread joined." << std::endl;
@@ -26,15 +26,26 @@
 #define MCP_SERVER_SERVER_H
 
 #include <memory>
-#include <queue>
 #include <thread>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <string_view>
+#include <mutex>
 #include <condition_variable>
 #include "ITransport.h"
 #include "json.hpp"
+#include "utils/ThreadPool.h"
+#include "utils/MPSCQueue.h"
 
 using json = nlohmann::json;
 
 #define MAX_PARSER_ERRORS 50
+#define DEFAULT_DISPATCH_WORKERS 4
+#define OUTPUT_QUEUE_CAPACITY 4096
+#define MAX_WRITE_BATCH 256
+#define RESPONSE_STREAM_CHUNK (64 * 1024)
+#define DEFERRED_DRAIN_TIMEOUT_MS 5000
 
 namespace vx::mcp {
 
@@ -44,6 +55,76 @@ namespace vx::mcp {
         PROMPTS = 0 << 3,
     };
 
+    /// The response to a request, with its result written in pieces as the handler produces it.
+    /// Pieces are gathered up to RESPONSE_STREAM_CHUNK bytes and go to the transport as they come
+    /// when it can take the response incrementally; otherwise the whole response is kept and
+    /// returned by Close(), for the handler to return it as usual.
+    class ResponseStream {
+    public:
+        ResponseStream(const ResponseStream&) = delete;
+        ResponseStream& operator=(const ResponseStream&) = delete;
+        ~ResponseStream() { Abort({}); } // left by an exception: never passes for a complete response
+
+        /// Append to the serialized result; false once nobody waits for it anymore
+        bool Write(std::string_view data);
+        /// Something was written
+        bool Started() const { return started_; }
+        /// End the response. Returns what the handler still has to send: empty when the
+        /// transport already got it, or when nothing was written
+        std::string Close();
+        /// Give up on the result: `response` answers instead while none of it went out, otherwise
+        /// (or without `response`) the transport cuts the message off. Returns what the handler
+        /// still has to send, like Close()
+        std::string Abort(std::string response);
+
+    private:
+        friend class Server;
+        ResponseStream(std::shared_ptr<ITransport> transport, uint64_t session, const json& request);
+
+        std::shared_ptr<ITransport> transport_; // null: keep everything for Close()
+        uint64_t session_ = 0;
+        MessageId id_;
+        std::string head_;
+        std::string buffer_;
+        std::unique_ptr<OutboundStream> stream_;
+        bool started_ = false;
+        bool flushed_ = false;
+        bool closed_ = false;
+        bool open_ = true;
+    };
+
+    class Server;
+
+    /// The response to a request, handed over later from any thread (see Server::DeferResponse).
+    /// Copies share the same response.
+    class DeferredResponse {
+    public:
+        /// Hand over the response (empty for none); only the first call counts
+        void Complete(std::string response) const;
+        /// Send a notification about the request, e.g. progress, until it is complete
+        void Notify(const std::string& pluginName, const char* notification) const;
+        /// What the callback that deferred the response returns: empty, the response goes out by
+        /// itself once complete. Where the response is needed on the spot (batch element,
+        /// run-to-completion), waits for Complete() and returns it.
+        std::string Await() const;
+
+    private:
+        friend class Server;
+        struct State {
+            Server* server = nullptr;
+            uint64_t session = 0;
+            MessageId id;
+            bool standalone = false;
+            std::mutex mutex;
+            std::condition_variable completed;
+            bool done = false;
+            std::string response;
+        };
+        explicit DeferredResponse(std::shared_ptr<State> state) : state_(std::move(state)) {}
+
+        std::shared_ptr<State> state_;
+    };
+
     class Server {
     public:
         Server();
@@ -64,12 +145,43 @@ namespace vx::mcp {
         inline bool IsValid() { return transport_ != nullptr; }
         inline void VerboseLevel(int level) { verboseLevel_ = level; }
         inline void Name(const std::string& name) { name_ = name; }
+        inline void Workers(int count) { workers_ = count; }   // 0 = handle requests on the reader thread
+        inline void WriteWindow(std::chrono::microseconds window) { writeWindow_ = window; } // max wait to coalesce output
+        inline void RunToCompletion(bool enabled) { runToCompletion_ = enabled; } // answer built-in methods on the transport's thread
         bool OverrideCallback(const std::string &method, std::function<json(const json&)> function);
+        // Same as OverrideCallback, but the callback returns the already serialized response.
+        // It also receives the request bytes as read by the transport (null-terminated), or an
+        // empty view when there are none, e.g. for the elements of a batch.
+        using RawCallback = std::function<std::string(const json& request, std::string_view raw)>;
+        bool OverrideRawCallback(const std::string &method, RawCallback function);
         void SendNotification(const std::string& pluginName, const char* notification);
+        // Response to the request this thread is handling, for callbacks producing their result in
+        // pieces. It goes to the client as it is written when the transport supports it and the
+        // request came alone, on a dispatch thread; the callback returns what Close() gives back.
+        ResponseStream OpenResponseStream();
+        // Response to the request this thread is handling, for callbacks that answer later from
+        // another thread: the dispatch thread is free as soon as the callback returns Await().
+        // Without dispatch workers (Workers(0)) Await() waits for it, keeping requests sequential.
+        DeferredResponse DeferResponse();
+        // Make `work` count as handling the request this thread is handling, wherever it runs:
+        // notifications, OpenResponseStream and DeferResponse behave there as they do here
+        std::function<void()> BindRequest(std::function<void()> work);
+        // Same, for work that outlives the caller's request: `request` stands for it there
+        std::function<void()> BindRequest(std::function<void()> work, std::shared_ptr<const json> request);
 
     private:
+        friend class DeferredResponse;
+
         void WriterLoop();
-        json HandleRequest(const json& request);
+        void InstallRunToCompletion();
+        void Dispatch(InboundMessage message);
+        void DispatchBatch(json batch, uint64_t session);
+        std::string ProcessRequest(const json& request, std::string_view raw = {}, uint64_t session = 0, bool standalone = false);
+        void WriteResponse(uint64_t session, MessageId id, std::string response);
+        void DeferredCompleted();
+        void AwaitDeferred();
+        void PushNotification(const std::string& pluginName, const char* notification, uint64_t session, MessageId id);
+        std::string HandleRequest(const json& request, std::string_view raw);
 
         json InitializeCmd(const json& request);
         json PingCmd(const json& request);
@@ -98,21 +210,34 @@ namespace vx::mcp {
 
     private:
         std::unordered_map<std::string, std::function<json(const json&)>> functionMap;
+        std::unordered_map<std::string, RawCallback> rawFunctionMap;
 
-        bool isStopping_ = false;
+        std::atomic<bool> isStopping_ = false;
         int verboseLevel_ = 0;
         int parserErrors_ = 0;
+        int workers_ = DEFAULT_DISPATCH_WORKERS;
+        std::chrono::microseconds writeWindow_ {0};
+        bool runToCompletion_ = false;
         std::string name_ = "mcp-server";
 
         std::shared_ptr<ITransport> transport_; // Store transport pointer
-        std::queue<std::string> notification_queue_;
-        std::mutex output_mutex_; // Protects both queue and transport writes
-        std::condition_variable queue_cv_;
+
+        // Responses and notifications; the writer thread is the only consumer
+        // and the only thread calling transport_->Write
+        utils::MPSCQueue<OutboundMessage> output_queue_ {OUTPUT_QUEUE_CAPACITY};
         std::thread writer_thread_;
         std::atomic<bool> writer_running_{false};
 
         std::thread reader_thread_;
         std::atomic<bool> reader_running_ = false;
+
+        // Requests carrying an id are handled here, off the reader thread
+        std::unique_ptr<utils::ThreadPool> dispatch_pool_;
+
+        // Deferred responses not completed yet: stopping waits for them before closing the output
+        std::mutex deferred_mutex_;
+        std::condition_variable deferred_cv_;
+        int deferred_pending_ = 0;
     };
 
 }
@@ -0,0 +1,1086 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "HttpServer.h"
+
+#include <cerrno>
+#include <cstring>
+#include <charconv>
+#include <algorithm>
+#include <unordered_map>
+#include <initializer_list>
+#include "aixlog.hpp"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#endif
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+namespace vx::transport {
+
+    using clock = std::chrono::steady_clock;
+
+#ifdef _WIN32
+    using socket_t = SOCKET;
+    static constexpr socket_t INVALID_SOCKET_FD = INVALID_SOCKET;
+    static void CloseSocket(socket_t fd) { ::closesocket(fd); }
+    static bool WouldBlock() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+    static bool Interrupted() { return WSAGetLastError() == WSAEINTR; }
+    static bool SetNonBlocking(socket_t fd) { u_long mode = 1; return ::ioctlsocket(fd, FIONBIO, &mode) == 0; }
+#else
+    using socket_t = int;
+    static constexpr socket_t INVALID_SOCKET_FD = -1;
+    static void CloseSocket(socket_t fd) { ::close(fd); }
+    static bool WouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK; }
+    static bool Interrupted() { return errno == EINTR; }
+    static bool SetNonBlocking(socket_t fd) {
+        int flags = ::fcntl(fd, F_GETFL, 0);
+        return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+#endif
+
+#ifdef MSG_NOSIGNAL
+    static constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+    static constexpr int SEND_FLAGS = 0;
+#endif
+
+    static std::string ToLower(std::string_view text) {
+        std::string result(text);
+        std::transform(result.begin(), result.end(), result.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return result;
+    }
+
+    static std::string_view Trim(std::string_view text) {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) text.remove_suffix(1);
+        return text;
+    }
+
+    static std::string UrlDecode(std::string_view text) {
+        std::string result;
+        result.reserve(text.size());
+        for (size_t i = 0; i < text.size(); i++) {
+            if (text[i] == '+') {
+                result.push_back(' ');
+            } else if (text[i] == '%' && i + 2 < text.size()) {
+                int value = 0;
+                auto [ptr, ec] = std::from_chars(text.data() + i + 1, text.data() + i + 3, value, 16);
+                if (ec == std::errc() && ptr == text.data() + i + 3) {
+                    result.push_back(static_cast<char>(value));
+                    i += 2;
+                } else {
+                    result.push_back(text[i]);
+                }
+            } else {
+                result.push_back(text[i]);
+            }
+        }
+        return result;
+    }
+
+    static const char* ReasonPhrase(int status) {
+        switch (status) {
+            case 100: return "Continue";
+            case 200: return "OK";
+            case 202: return "Accepted";
+            case 204: return "No Content";
+            case 400: return "Bad Request";
+            case 404: return "Not Found";
+            case 405: return "Method Not Allowed";
+            case 406: return "Not Acceptable";
+            case 408: return "Request Timeout";
+            case 409: return "Conflict";
+            case 413: return "Payload Too Large";
+            case 415: return "Unsupported Media Type";
+            case 431: return "Request Header Fields Too Large";
+            case 500: return "Internal Server Error";
+            case 501: return "Not Implemented";
+            case 503: return "Service Unavailable";
+            case 504: return "Gateway Timeout";
+            default: return "Unknown";
+        }
+    }
+
+    static std::string ResponseHead(int status, const HttpHeaders& headers) {
+        std::string head = "HTTP/1.1 " + std::to_string(status) + " " + ReasonPhrase(status) + "\r\n";
+        for (const auto& [name, value] : headers) {
+            head.append(name).append(": ").append(value).append("\r\n");
+        }
+        return head;
+    }
+
+    //============================================================================================
+    // HttpRequest
+    //============================================================================================
+
+    std::string HttpRequest::Header(std::string_view name) const {
+        std::string key = ToLower(name);
+        for (const auto& [header, value] : headers) {
+            if (header == key) return value;
+        }
+        return {};
+    }
+
+    std::string HttpRequest::Query(std::string_view name) const {
+        std::string_view rest = query;
+        while (!rest.empty()) {
+            size_t amp = rest.find('&');
+            std::string_view pair = rest.substr(0, amp);
+            rest = amp == std::string_view::npos ? std::string_view() : rest.substr(amp + 1);
+
+            size_t eq = pair.find('=');
+            if (UrlDecode(pair.substr(0, eq)) == name) {
+                return eq == std::string_view::npos ? std::string() : UrlDecode(pair.substr(eq + 1));
+            }
+        }
+        return {};
+    }
+
+    //============================================================================================
+    // Poller: epoll on Linux, poll()/WSAPoll() elsewhere
+    //============================================================================================
+
+    class HttpPoller {
+    public:
+        struct Event {
+            socket_t fd;
+            bool readable;
+            bool writable;
+        };
+
+        HttpPoller() = default;
+        HttpPoller(const HttpPoller&) = delete;
+        HttpPoller& operator=(const HttpPoller&) = delete;
+
+#ifdef __linux__
+        ~HttpPoller() {
+            if (wake_ >= 0) ::close(wake_);
+            if (epoll_ >= 0) ::close(epoll_);
+        }
+
+        bool Init() {
+            epoll_ = ::epoll_create1(EPOLL_CLOEXEC);
+            wake_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (epoll_ < 0 || wake_ < 0) return false;
+            epoll_event event {};
+            event.events = EPOLLIN;
+            event.data.fd = wake_;
+            return ::epoll_ctl(epoll_, EPOLL_CTL_ADD, wake_, &event) == 0;
+        }
+
+        void Add(socket_t fd) { Control(EPOLL_CTL_ADD, fd, true, false); }
+        void Watch(socket_t fd, bool read, bool write) { Control(EPOLL_CTL_MOD, fd, read, write); }
+        void Remove(socket_t fd) { ::epoll_ctl(epoll_, EPOLL_CTL_DEL, fd, nullptr); }
+
+        void Wake() {
+            uint64_t one = 1;
+            [[maybe_unused]] auto written = ::write(wake_, &one, sizeof(one));
+        }
+
+        void Wait(std::vector<Event>& events, int timeoutMs) {
+            events.clear();
+            epoll_event ready[256];
+            int count = ::epoll_wait(epoll_, ready, 256, timeoutMs);
+            for (int i = 0; i < count; i++) {
+                if (ready[i].data.fd == wake_) {
+                    uint64_t value;
+                    [[maybe_unused]] auto drained = ::read(wake_, &value, sizeof(value));
+                    continue;
+                }
+                uint32_t flags = ready[i].events;
+                // errors and hang-ups surface as a failing read, which closes the connection
+                events.push_back({ready[i].data.fd,
+                                  (flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0,
+                                  (flags & EPOLLOUT) != 0});
+            }
+        }
+
+    private:
+        void Control(int operation, socket_t fd, bool read, bool write) {
+            epoll_event event {};
+            event.events = (read ? static_cast<uint32_t>(EPOLLIN | EPOLLRDHUP) : 0u) | (write ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+            event.data.fd = fd;
+            ::epoll_ctl(epoll_, operation, fd, &event);
+        }
+
+        int epoll_ = -1;
+        int wake_ = -1;
+#else
+        ~HttpPoller() {
+            if (wake_ != INVALID_SOCKET_FD) CloseSocket(wake_);
+        }
+
+        bool Init() {
+            // a UDP socket connected to itself: sending one byte wakes up poll()
+            wake_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+            if (wake_ == INVALID_SOCKET_FD) return false;
+            sockaddr_in address {};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t length = sizeof(address);
+            return ::bind(wake_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0
+                && ::getsockname(wake_, reinterpret_cast<sockaddr*>(&address), &length) == 0
+                && ::connect(wake_, reinterpret_cast<sockaddr*>(&address), length) == 0
+                && SetNonBlocking(wake_);
+        }
+
+        void Add(socket_t fd) { interest_[fd] = POLLIN; }
+        void Watch(socket_t fd, bool read, bool write) { interest_[fd] = static_cast<short>((read ? POLLIN : 0) | (write ? POLLOUT : 0)); }
+        void Remove(socket_t fd) { interest_.erase(fd); }
+
+        void Wake() {
+            char byte = 1;
+            ::send(wake_, &byte, 1, 0);
+        }
+
+        void Wait(std::vector<Event>& events, int timeoutMs) {
+            events.clear();
+            fds_.clear();
+            fds_.push_back({wake_, POLLIN, 0});
+            for (const auto& [fd, events] : interest_) {
+                fds_.push_back({fd, events, 0});
+            }
+#ifdef _WIN32
+            int count = ::WSAPoll(fds_.data(), static_cast<ULONG>(fds_.size()), timeoutMs);
+#else
+            int count = ::poll(fds_.data(), static_cast<nfds_t>(fds_.size()), timeoutMs);
+#endif
+            if (count <= 0) return;
+            if (fds_[0].revents != 0) {
+                char buffer[64];
+                while (::recv(wake_, buffer, sizeof(buffer), 0) > 0) {}
+            }
+            for (size_t i = 1; i < fds_.size(); i++) {
+                short flags = fds_[i].revents;
+                if (flags == 0) continue;
+                events.push_back({fds_[i].fd, (flags & (POLLIN | POLLHUP | POLLERR)) != 0, (flags & POLLOUT) != 0});
+            }
+        }
+
+    private:
+        socket_t wake_ = INVALID_SOCKET_FD;
+        std::unordered_map<socket_t, short> interest_;
+        std::vector<pollfd> fds_;
+#endif
+    };
+
+    //============================================================================================
+    // Event loop: one per I/O thread
+    //============================================================================================
+
+    class HttpEventLoop : public std::enable_shared_from_this<HttpEventLoop> {
+    public:
+        explicit HttpEventLoop(HttpServer& server) : server_(server) {}
+
+        bool Init() { return poller_.Init(); }
+        void Run();
+        void Stop() {
+            stopping_ = true;
+            poller_.Wake();
+        }
+
+        void Post(std::function<void()> task) {
+            {
+                std::lock_guard<std::mutex> lock(tasks_mutex_);
+                tasks_.push_back(std::move(task));
+            }
+            poller_.Wake();
+        }
+
+        bool InLoop() const { return std::this_thread::get_id() == thread_id_.load(std::memory_order_relaxed); }
+
+        void AddListener(socket_t fd) {
+            listener_ = fd;
+            poller_.Add(fd);
+        }
+
+        void Adopt(socket_t fd);
+        void Watch(socket_t fd, bool read, bool write) { poller_.Watch(fd, read, write); }
+        void Forget(socket_t fd) {
+            poller_.Remove(fd);
+            connections_.erase(fd);
+        }
+
+    private:
+        void Accept();
+        void RunTasks();
+
+        HttpServer& server_;
+        HttpPoller poller_;
+        socket_t listener_ = INVALID_SOCKET_FD;
+        std::unordered_map<socket_t, std::shared_ptr<HttpConnection>> connections_;
+        std::mutex tasks_mutex_;
+        std::vector<std::function<void()>> tasks_;
+        std::atomic<bool> stopping_ {false};
+        std::atomic<std::thread::id> thread_id_ {};
+    };
+
+    //============================================================================================
+    // Connection: per-connection state machine, only touched by its I/O thread
+    //============================================================================================
+
+    class HttpConnection : public std::enable_shared_from_this<HttpConnection> {
+    public:
+        HttpConnection(HttpServer& server, HttpEventLoop& loop, socket_t fd)
+            : server_(server), loop_(loop), fd_(fd), lastActivity_(clock::now()), lastWrite_(clock::now()) {}
+
+        void OnReadable();
+        void OnWritable() { Flush(); }
+        void Housekeeping(clock::time_point now);
+        void Close();
+        bool IsClosed() const { return fd_ == INVALID_SOCKET_FD; }
+        size_t Unsent() const { return output_.size() - outputPos_; }
+
+        // HttpExchange operations, run on the I/O thread
+        void Respond(HttpExchange& exchange, int status, const HttpHeaders& headers, std::string_view body);
+        void StartStream(HttpExchange& exchange, int status, const HttpHeaders& headers);
+        void SendChunk(HttpExchange& exchange, std::string_view data);
+        void EndStream(HttpExchange& exchange);
+        void AbortExchange(HttpExchange& exchange);
+
+    private:
+        enum class Phase { Head, Body, Exchange };
+
+        void ProcessInput();
+        int ParseHead(std::string_view head);
+        void Dispatch();
+        void Finish();
+        void Fail(int status);
+        void Write(std::initializer_list<std::string_view> parts);
+        void Flush();
+        void UpdateInterest();
+        bool IsCurrent(const HttpExchange& exchange) const { return !IsClosed() && exchange_.get() == &exchange; }
+
+        HttpServer& server_;
+        HttpEventLoop& loop_;
+        socket_t fd_;
+
+        std::string input_;
+        size_t inputPos_ = 0;
+        std::string output_;
+        size_t outputPos_ = 0;
+        bool writeInterest_ = false;
+        bool peerClosed_ = false; // the client shut down its side: nothing more to read
+        bool readClosed_ = false; // reads are not watched anymore
+
+        Phase phase_ = Phase::Head;
+        HttpRequest request_;
+        size_t contentLength_ = 0;
+        bool expectContinue_ = false;
+        bool keepAlive_ = true;
+        bool closeAfterWrite_ = false;
+        bool processing_ = false;
+        std::shared_ptr<HttpExchange> exchange_;
+
+        clock::time_point lastActivity_;
+        clock::time_point lastWrite_;
+        clock::time_point deadline_;
+    };
+
+    void HttpConnection::OnReadable() {
+        constexpr size_t block = 16 * 1024;
+        while (true) {
+            size_t used = input_.size();
+            input_.resize(used + block);
+            auto count = ::recv(fd_, &input_[used], static_cast<int>(block), 0);
+            if (count > 0) {
+                input_.resize(used + static_cast<size_t>(count));
+                if (static_cast<size_t>(count) < block) break;
+                continue;
+            }
+            input_.resize(used);
+            if (count < 0 && Interrupted()) continue;
+            if (count < 0 && WouldBlock()) break;
+            if (count < 0) {
+                Close(); // the client is gone
+                return;
+            }
+            if (peerClosed_) return; // hang-up reported again, the answer is still on its way
+            // orderly shutdown: the client may still wait for the answer to what it sent,
+            // the requests buffered go through before the connection closes (see ProcessInput)
+            peerClosed_ = true;
+            UpdateInterest();
+            break;
+        }
+
+        lastActivity_ = clock::now();
+        if (phase_ == Phase::Exchange && input_.size() - inputPos_ > HTTP_MAX_HEADER_SIZE + HTTP_MAX_BODY_SIZE) {
+            LOG(WARNING) << "HTTP client pipelined too much data, closing connection" << std::endl;
+            Close();
+            return;
+        }
+        ProcessInput();
+    }
+
+    void HttpConnection::ProcessInput() {
+        if (processing_) return;
+        processing_ = true;
+
+        while (!IsClosed() && !closeAfterWrite_) {
+            if (phase_ == Phase::Head) {
+                // tolerate stray line breaks between pipelined requests
+                while (inputPos_ < input_.size() && (input_[inputPos_] == '\r' || input_[inputPos_] == '\n')) {
+                    inputPos_++;
+                }
+                std::string_view available(input_.data() + inputPos_, input_.size() - inputPos_);
+                size_t end = available.find("\r\n\r\n");
+                if (end == std::string_view::npos || end > HTTP_MAX_HEADER_SIZE) {
+                    if (available.size() > HTTP_MAX_HEADER_SIZE) Fail(431);
+                    break;
+                }
+                if (int status = ParseHead(available.substr(0, end)); status != 0) {
+                    Fail(status);
+                    break;
+                }
+                inputPos_ += end + 4;
+                phase_ = Phase::Body;
+                if (expectContinue_ && input_.size() - inputPos_ < contentLength_) {
+                    Write({"HTTP/1.1 100 Continue\r\n\r\n"});
+                }
+            }
+
+            if (phase_ == Phase::Body) {
+                if (input_.size() - inputPos_ < contentLength_) break;
+                request_.body.assign(input_, inputPos_, contentLength_);
+                inputPos_ += contentLength_;
+                Dispatch(); // may complete synchronously, then the next pipelined request follows
+                continue;
+            }
+
+            break; // waiting for the current exchange to be answered
+        }
+
+        if (inputPos_ == input_.size()) {
+            input_.clear();
+            inputPos_ = 0;
+        } else if (inputPos_ > HTTP_MAX_HEADER_SIZE) {
+            input_.erase(0, inputPos_);
+            inputPos_ = 0;
+        }
+        processing_ = false;
+
+        if (peerClosed_ && phase_ != Phase::Exchange && !IsClosed() && !closeAfterWrite_) {
+            // every complete request was answered: close once the answers are out
+            closeAfterWrite_ = true;
+            Flush();
+        }
+    }
+
+    int HttpConnection::ParseHead(std::string_view head) {
+        request_ = HttpRequest();
+        contentLength_ = 0;
+        expectContinue_ = false;
+
+        size_t lineEnd = head.find("\r\n");
+        std::string_view line = head.substr(0, lineEnd);
+        size_t first = line.find(' ');
+        size_t last = line.rfind(' ');
+        if (first == std::string_view::npos || last == first) return 400;
+        request_.method = std::string(line.substr(0, first));
+        request_.target = std::string(line.substr(first + 1, last - first - 1));
+        request_.version = std::string(line.substr(last + 1));
+        if (request_.version != "HTTP/1.1" && request_.version != "HTTP/1.0") return 400;
+
+        size_t question = request_.target.find('?');
+        request_.path = request_.target.substr(0, question);
+        if (question != std::string::npos) request_.query = request_.target.substr(question + 1);
+
+        std::string_view rest = lineEnd == std::string_view::npos ? std::string_view() : head.substr(lineEnd + 2);
+        while (!rest.empty()) {
+            size_t end = rest.find("\r\n");
+            std::string_view header = rest.substr(0, end);
+            rest = end == std::string_view::npos ? std::string_view() : rest.substr(end + 2);
+
+            size_t colon = header.find(':');
+            if (colon == std::string_view::npos || colon == 0) return 400;
+            request_.headers.emplace_back(ToLower(Trim(header.substr(0, colon))),
+                                          std::string(Trim(header.substr(colon + 1))));
+        }
+
+        std::string length = request_.Header("content-length");
+        if (!length.empty()) {
+            auto [ptr, ec] = std::from_chars(length.data(), length.data() + length.size(), contentLength_);
+            if (ec != std::errc() || ptr != length.data() + length.size()) return 400;
+            if (contentLength_ > HTTP_MAX_BODY_SIZE) return 413;
+        }
+        std::string encoding = ToLower(request_.Header("transfer-encoding"));
+        if (!encoding.empty() && encoding != "identity") return 501;
+
+        std::string connection = ToLower(request_.Header("connection"));
+        keepAlive_ = request_.version == "HTTP/1.1" ? connection.find("close") == std::string::npos
+                                                    : connection.find("keep-alive") != std::string::npos;
+        expectContinue_ = ToLower(request_.Header("expect")) == "100-continue";
+        return 0;
+    }
+
+    void HttpConnection::Dispatch() {
+        phase_ = Phase::Exchange;
+        deadline_ = clock::now() + server_.responseTimeout_;
+        auto exchange = std::make_shared<HttpExchange>(std::move(request_), weak_from_this(), loop_.weak_from_this());
+        request_ = HttpRequest();
+        exchange_ = exchange;
+
+        bool pathFound = false;
+        const HttpServer::Handler* handler = server_.FindHandler(exchange->Request(), pathFound);
+        if (!handler) {
+            exchange->Respond(pathFound ? 405 : 404, {});
+            return;
+        }
+
+        try {
+            (*handler)(exchange);
+        } catch (const std::exception& e) {
+            LOG(ERROR) << "Exception in HTTP handler " << exchange->Request().method << " "
+                       << exchange->Request().path << ": " << e.what() << std::endl;
+            exchange->Respond(500, {});
+        }
+    }
+
+    void HttpConnection::Finish() {
+        if (exchange_) {
+            exchange_->Finished();
+            exchange_.reset();
+        }
+        phase_ = Phase::Head;
+        lastActivity_ = clock::now();
+        if (!keepAlive_) {
+            closeAfterWrite_ = true;
+            Flush();
+            return;
+        }
+        ProcessInput(); // requests pipelined behind the one just answered
+    }
+
+    void HttpConnection::Fail(int status) {
+        keepAlive_ = false;
+        closeAfterWrite_ = true;
+        std::string head = ResponseHead(status, {});
+        head.append("Content-Length: 0\r\nConnection: close\r\n\r\n");
+        Write({head});
+        Flush();
+    }
+
+    void HttpConnection::Respond(HttpExchange& exchange, int status, const HttpHeaders& headers, std::string_view body) {
+        if (!IsCurrent(exchange)) return;
+        std::string head = ResponseHead(status, headers);
+        head.append("Content-Length: ").append(std::to_string(body.size())).append("\r\n");
+        if (!keepAlive_) head.append("Connection: close\r\n");
+        head.append("\r\n");
+        Write({head, body});
+        Finish();
+    }
+
+    void HttpConnection::StartStream(HttpExchange& exchange, int status, const HttpHeaders& headers) {
+        if (!IsCurrent(exchange)) return;
+        std::string head = ResponseHead(status, headers);
+        head.append("Transfer-Encoding: chunked\r\n");
+        if (!keepAlive_) head.append("Connection: close\r\n");
+        head.append("\r\n");
+        Write({head});
+    }
+
+    void HttpConnection::SendChunk(HttpExchange& exchange, std::string_view data) {
+        if (!IsCurrent(exchange) || data.empty()) return; // an empty chunk would end the stream
+        char size[24];
+        auto [end, ec] = std::to_chars(size, size + sizeof(size) - 2, data.size(), 16);
+        *end++ = '\r';
+        *end++ = '\n';
+        Write({std::string_view(size, end - size), data, "\r\n"});
+    }
+
+    void HttpConnection::EndStream(HttpExchange& exchange) {
+        if (!IsCurrent(exchange)) return;
+        Write({"0\r\n\r\n"});
+        Finish();
+    }
+
+    void HttpConnection::AbortExchange(HttpExchange& exchange) {
+        if (!IsCurrent(exchange)) return;
+        Close();
+    }
+
+    void HttpConnection::Write(std::initializer_list<std::string_view> parts) {
+        if (IsClosed()) return;
+        lastWrite_ = clock::now();
+
+        size_t sent = 0;
+        if (outputPos_ == output_.size()) {
+            // nothing queued: hand the parts to the socket directly, copy only what does not fit
+            output_.clear();
+            outputPos_ = 0;
+#ifdef _WIN32
+            WSABUF buffers[4];
+            DWORD count = 0;
+            for (auto part : parts) {
+                buffers[count++] = {static_cast<ULONG>(part.size()), const_cast<char*>(part.data())};
+            }
+            DWORD written = 0;
+            if (::WSASend(fd_, buffers, count, &written, 0, nullptr, nullptr) == 0) {
+                sent = written;
+            } else if (!WouldBlock()) {
+                Close();
+                return;
+            }
+#else
+            iovec buffers[4];
+            size_t count = 0;
+            for (auto part : parts) {
+                buffers[count++] = {const_cast<char*>(part.data()), part.size()};
+            }
+            msghdr message {};
+            message.msg_iov = buffers;
+            message.msg_iovlen = count;
+            ssize_t written;
+            do {
+                written = ::sendmsg(fd_, &message, SEND_FLAGS);
+            } while (written < 0 && Interrupted());
+            if (written >= 0) {
+                sent = static_cast<size_t>(written);
+            } else if (!WouldBlock()) {
+                Close();
+                return;
+            }
+#endif
+        }
+
+        for (auto part : parts) {
+            if (sent >= part.size()) {
+                sent -= part.size();
+                continue;
+            }
+            output_.append(part.substr(sent));
+            sent = 0;
+        }
+
+        if (output_.size() - outputPos_ > HTTP_MAX_PENDING_OUTPUT) {
+            LOG(WARNING) << "HTTP client is not reading its data, closing connection" << std::endl;
+            Close();
+            return;
+        }
+        UpdateInterest();
+    }
+
+    void HttpConnection::Flush() {
+        while (!IsClosed() && outputPos_ < output_.size()) {
+            auto count = ::send(fd_, output_.data() + outputPos_, static_cast<int>(output_.size() - outputPos_), SEND_FLAGS);
+            if (count < 0) {
+                if (Interrupted()) continue;
+                if (WouldBlock()) break;
+                Close();
+                return;
+            }
+            outputPos_ += static_cast<size_t>(count);
+        }
+        if (IsClosed()) return;
+        if (exchange_) exchange_->Progress(Unsent());
+
+        if (outputPos_ == output_.size()) {
+            output_.clear();
+            outputPos_ = 0;
+            if (closeAfterWrite_) {
+                Close();
+                return;
+            }
+        }
+        UpdateInterest();
+    }
+
+    void HttpConnection::UpdateInterest() {
+        bool pending = outputPos_ < output_.size();
+        if (pending != writeInterest_ || peerClosed_ != readClosed_) {
+            writeInterest_ = pending;
+            readClosed_ = peerClosed_;
+            loop_.Watch(fd_, !peerClosed_, pending);
+        }
+    }
+
+    void HttpConnection::Housekeeping(clock::time_point now) {
+        if (phase_ != Phase::Exchange) {
+            if (now - lastActivity_ >= std::chrono::seconds(HTTP_IDLE_TIMEOUT_SECONDS)) {
+                Close(); // idle keep-alive connection, or a request that never completes
+            }
+            return;
+        }
+
+        auto exchange = exchange_;
+        if (!exchange) return;
+        if (!exchange->Responded()) {
+            if (now >= deadline_) exchange->TimedOut();
+        } else if (exchange->state_.load() == HttpExchange::State::Streaming && exchange->keepAlive_.load() &&
+                   server_.keepAliveInterval_.count() > 0 && now - lastWrite_ >= server_.keepAliveInterval_) {
+            SendChunk(*exchange, server_.keepAliveData_);
+        }
+    }
+
+    void HttpConnection::Close() {
+        if (IsClosed()) return;
+        socket_t fd = fd_;
+        fd_ = INVALID_SOCKET_FD;
+        CloseSocket(fd);
+
+        auto self = shared_from_this(); // Forget drops the loop's reference
+        loop_.Forget(fd);
+        if (exchange_) {
+            auto exchange = std::move(exchange_);
+            exchange->Closed();
+        }
+    }
+
+    //============================================================================================
+    // HttpEventLoop
+    //============================================================================================
+
+    void HttpEventLoop::Run() {
+        thread_id_.store(std::this_thread::get_id(), std::memory_order_relaxed);
+        std::vector<HttpPoller::Event> events;
+        auto lastHousekeeping = clock::now();
+
+        while (!stopping_) {
+            poller_.Wait(events, 1000);
+            for (const auto& event : events) {
+                if (event.fd == listener_) {
+                    Accept();
+                    continue;
+                }
+                auto it = connections_.find(event.fd);
+                if (it == connections_.end()) continue;
+                auto connection = it->second;
+                if (event.writable) connection->OnWritable();
+                if (event.readable && !connection->IsClosed()) connection->OnReadable();
+            }
+            RunTasks();
+
+            auto now = clock::now();
+            if (now - lastHousekeeping >= std::chrono::seconds(1)) {
+                lastHousekeeping = now;
+                std::vector<std::shared_ptr<HttpConnection>> snapshot;
+                snapshot.reserve(connections_.size());
+                for (const auto& [fd, connection] : connections_) snapshot.push_back(connection);
+                for (const auto& connection : snapshot) connection->Housekeeping(now);
+            }
+        }
+
+        // shutting down: every connection still open is closed, which tells its exchange
+        std::vector<std::shared_ptr<HttpConnection>> remaining;
+        for (const auto& [fd, connection] : connections_) remaining.push_back(connection);
+        for (const auto& connection : remaining) connection->Close();
+        if (listener_ != INVALID_SOCKET_FD) {
+            poller_.Remove(listener_);
+            CloseSocket(listener_);
+            listener_ = INVALID_SOCKET_FD;
+        }
+        std::lock_guard<std::mutex> lock(tasks_mutex_);
+        tasks_.clear();
+    }
+
+    void HttpEventLoop::RunTasks() {
+        std::vector<std::function<void()>> tasks;
+        {
+            std::lock_guard<std::mutex> lock(tasks_mutex_);
+            tasks.swap(tasks_);
+        }
+        for (auto& task : tasks) task();
+    }
+
+    void HttpEventLoop::Accept() {
+        while (true) {
+            socket_t fd = ::accept(listener_, nullptr, nullptr);
+            if (fd == INVALID_SOCKET_FD) {
+                if (Interrupted()) continue;
+                if (!WouldBlock()) LOG(ERROR) << "HTTP accept failed: " << std::strerror(errno) << std::endl;
+                return;
+            }
+            if (!SetNonBlocking(fd)) {
+                CloseSocket(fd);
+                continue;
+            }
+            int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&one), sizeof(one));
+#ifdef SO_NOSIGPIPE
+            ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+            // spread the connections over the I/O threads
+            auto& loop = server_.NextLoop();
+            if (&loop == this) {
+                Adopt(fd);
+            } else {
+                loop.Post([target = loop.shared_from_this(), fd]() { target->Adopt(fd); });
+            }
+        }
+    }
+
+    void HttpEventLoop::Adopt(socket_t fd) {
+        if (stopping_) {
+            CloseSocket(fd);
+            return;
+        }
+        connections_[fd] = std::make_shared<HttpConnection>(server_, *this, fd);
+        poller_.Add(fd);
+    }
+
+    //============================================================================================
+    // HttpExchange
+    //============================================================================================
+
+    HttpExchange::HttpExchange(HttpRequest request, std::weak_ptr<HttpConnection> connection, std::weak_ptr<HttpEventLoop> loop)
+        : request_(std::move(request)), connection_(std::move(connection)), loop_(std::move(loop)) {}
+
+    void HttpExchange::RunOnLoop(std::function<void(HttpConnection&)> task) {
+        auto loop = loop_.lock();
+        auto connection = connection_.lock();
+        if (!loop || !connection) return;
+        if (loop->InLoop()) {
+            task(*connection);
+        } else {
+            loop->Post([connection, task = std::move(task)]() { task(*connection); });
+        }
+    }
+
+    void HttpExchange::Respond(int status, HttpHeaders headers, std::string body) {
+        State expected = State::Pending;
+        if (!state_.compare_exchange_strong(expected, State::Done)) return;
+        RunOnLoop([self = shared_from_this(), status, headers = std::move(headers), body = std::move(body)](HttpConnection& connection) {
+            connection.Respond(*self, status, headers, body);
+        });
+    }
+
+    void HttpExchange::StartStream(int status, HttpHeaders headers) {
+        State expected = State::Pending;
+        if (!state_.compare_exchange_strong(expected, State::Streaming)) return;
+        RunOnLoop([self = shared_from_this(), status, headers = std::move(headers)](HttpConnection& connection) {
+            connection.StartStream(*self, status, headers);
+        });
+    }
+
+    bool HttpExchange::Send(std::string data) {
+        if (state_.load() != State::Streaming || !open_.load()) return false;
+        queued_.fetch_add(data.size());
+        RunOnLoop([self = shared_from_this(), data = std::move(data)](HttpConnection& connection) {
+            connection.SendChunk(*self, data);
+            self->queued_.fetch_sub(data.size());
+            self->Progress(connection.Unsent());
+        });
+        return true;
+    }
+
+    void HttpExchange::End() {
+        State expected = State::Streaming;
+        if (!state_.compare_exchange_strong(expected, State::Done)) return;
+        RunOnLoop([self = shared_from_this()](HttpConnection& connection) {
+            connection.EndStream(*self);
+        });
+    }
+
+    void HttpExchange::Abort() {
+        if (state_.exchange(State::Done) == State::Done) return;
+        RunOnLoop([self = shared_from_this()](HttpConnection& connection) {
+            connection.AbortExchange(*self);
+        });
+    }
+
+    bool HttpExchange::WaitBacklog(size_t limit) {
+        std::unique_lock<std::mutex> lock(backlog_mutex_);
+        waiting_ = true;
+        backlog_cv_.wait(lock, [this, limit]() {
+            return !open_.load() || queued_.load() + unsent_.load() < limit;
+        });
+        waiting_ = false;
+        return open_.load();
+    }
+
+    void HttpExchange::Progress(size_t unsent) {
+        unsent_ = unsent;
+        if (waiting_.load()) WakeWaiters();
+    }
+
+    void HttpExchange::WakeWaiters() {
+        std::lock_guard<std::mutex> lock(backlog_mutex_);
+        backlog_cv_.notify_all();
+    }
+
+    void HttpExchange::OnClose(std::function<void()> callback) {
+        std::lock_guard<std::mutex> lock(callbacks_mutex_);
+        on_close_ = std::move(callback);
+    }
+
+    void HttpExchange::OnTimeout(std::function<void()> callback) {
+        std::lock_guard<std::mutex> lock(callbacks_mutex_);
+        on_timeout_ = std::move(callback);
+    }
+
+    void HttpExchange::Finished() {
+        open_ = false;
+        state_ = State::Done;
+        WakeWaiters();
+        std::lock_guard<std::mutex> lock(callbacks_mutex_);
+        on_close_ = nullptr;
+        on_timeout_ = nullptr;
+    }
+
+    void HttpExchange::Closed() {
+        open_ = false;
+        state_ = State::Done;
+        WakeWaiters();
+        std::function<void()> callback;
+        {
+            std::lock_guard<std::mutex> lock(callbacks_mutex_);
+            callback = std::move(on_close_);
+            on_timeout_ = nullptr;
+        }
+        if (callback) callback();
+    }
+
+    void HttpExchange::TimedOut() {
+        std::function<void()> callback;
+        {
+            std::lock_guard<std::mutex> lock(callbacks_mutex_);
+            callback = std::move(on_timeout_);
+        }
+        if (callback) callback();
+        Respond(504, {});
+    }
+
+    //============================================================================================
+    // HttpServer
+    //============================================================================================
+
+    HttpServer::HttpServer(size_t ioThreads) : ioThreads_(ioThreads == 0 ? 1 : ioThreads) {}
+
+    HttpServer::~HttpServer() {
+        Stop();
+    }
+
+    void HttpServer::Route(std::string method, std::string path, Handler handler) {
+        routes_.push_back({std::move(method), std::move(path), std::move(handler)});
+    }
+
+    void HttpServer::StreamKeepAlive(std::string data, std::chrono::seconds interval) {
+        keepAliveData_ = std::move(data);
+        keepAliveInterval_ = interval;
+    }
+
+    const HttpServer::Handler* HttpServer::FindHandler(const HttpRequest& request, bool& pathFound) const {
+        for (const auto& route : routes_) {
+            bool wildcard = route.path == "*";
+            if (!wildcard && route.path != request.path) continue;
+            if (route.method == request.method) return &route.handler;
+            pathFound = pathFound || !wildcard;
+        }
+        return nullptr;
+    }
+
+    HttpEventLoop& HttpServer::NextLoop() {
+        return *loops_[nextLoop_.fetch_add(1, std::memory_order_relaxed) % loops_.size()];
+    }
+
+    bool HttpServer::Listen(const std::string& host, int port) {
+        std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+        if (running_.load()) return false;
+
+#ifdef _WIN32
+        WSADATA wsaData;
+        ::WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+
+        addrinfo hints {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE;
+        addrinfo* addresses = nullptr;
+        std::string service = std::to_string(port);
+        if (::getaddrinfo(host.c_str(), service.c_str(), &hints, &addresses) != 0) {
+            LOG(ERROR) << "Cannot resolve " << host << std::endl;
+            return false;
+        }
+
+        socket_t listener = INVALID_SOCKET_FD;
+        for (addrinfo* address = addresses; address; address = address->ai_next) {
+            listener = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+            if (listener == INVALID_SOCKET_FD) continue;
+            int one = 1;
+            ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&one), sizeof(one));
+            if (::bind(listener, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0 &&
+                ::listen(listener, SOMAXCONN) == 0 && SetNonBlocking(listener)) {
+                break;
+            }
+            CloseSocket(listener);
+            listener = INVALID_SOCKET_FD;
+        }
+        ::freeaddrinfo(addresses);
+        if (listener == INVALID_SOCKET_FD) {
+            LOG(ERROR) << "Cannot listen on " << host << ":" << port << std::endl;
+            return false;
+        }
+
+        loops_.clear();
+        for (size_t i = 0; i < ioThreads_; i++) {
+            auto loop = std::make_shared<HttpEventLoop>(*this);
+            if (!loop->Init()) {
+                LOG(ERROR) << "Cannot create the HTTP event loop" << std::endl;
+                CloseSocket(listener);
+                loops_.clear();
+                return false;
+            }
+            loops_.push_back(std::move(loop));
+        }
+        loops_.front()->AddListener(listener);
+
+        running_ = true;
+        for (auto& loop : loops_) {
+            threads_.emplace_back([loop]() { loop->Run(); });
+        }
+        LOG(INFO) << "HTTP server listening on " << host << ":" << port << " with " << ioThreads_ << " I/O thread(s)" << std::endl;
+        return true;
+    }
+
+    void HttpServer::Stop() {
+        std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+        if (!running_.exchange(false)) return;
+
+        for (auto& loop : loops_) loop->Stop();
+        for (auto& thread : threads_) {
+            if (thread.joinable()) thread.join();
+        }
+        threads_.clear();
+        loops_.clear();
+    }
+
+}
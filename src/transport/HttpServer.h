@@ -0,0 +1,193 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef MCP_SERVER_HTTP_SERVER_H
+#define MCP_SERVER_HTTP_SERVER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <condition_variable>
+
+#define HTTP_IO_THREADS 2
+#define HTTP_MAX_HEADER_SIZE (64 * 1024)
+#define HTTP_MAX_BODY_SIZE (64 * 1024 * 1024)
+#define HTTP_MAX_PENDING_OUTPUT (16 * 1024 * 1024)
+#define HTTP_RESPONSE_TIMEOUT_SECONDS 30
+#define HTTP_IDLE_TIMEOUT_SECONDS 60
+
+namespace vx::transport {
+
+    using HttpHeaders = std::vector<std::pair<std::string, std::string>>;
+
+    struct HttpRequest {
+        std::string method;
+        std::string target;     // as received, path and query string
+        std::string path;
+        std::string query;
+        std::string version;
+        HttpHeaders headers;    // names are lower-cased
+        std::string body;
+
+        /// Header value (name is case-insensitive), empty when missing
+        std::string Header(std::string_view name) const;
+        /// Url-decoded query string parameter, empty when missing
+        std::string Query(std::string_view name) const;
+    };
+
+    class HttpConnection;
+    class HttpEventLoop;
+
+    /// One request and its response. A handler can answer before returning, or keep
+    /// the exchange and answer later from any thread: every method is thread-safe and
+    /// the actual socket work always happens on the connection's I/O thread.
+    class HttpExchange : public std::enable_shared_from_this<HttpExchange> {
+    public:
+        HttpExchange(HttpRequest request, std::weak_ptr<HttpConnection> connection, std::weak_ptr<HttpEventLoop> loop);
+
+        const HttpRequest& Request() const { return request_; }
+        /// Move the request body out, e.g. to keep it as the message, leaving it empty in Request()
+        std::string TakeBody() { return std::move(request_.body); }
+
+        /// Complete response; Content-Length is added
+        void Respond(int status, HttpHeaders headers, std::string body = {});
+        /// Start a chunked response that stays open for Send(), e.g. a text/event-stream
+        void StartStream(int status, HttpHeaders headers);
+        /// Append to a started stream; false once the exchange is over
+        bool Send(std::string data);
+        /// Terminate a stream, the connection stays open for the next request
+        void End();
+        /// Drop the connection without completing the response, e.g. a stream that cannot be finished
+        void Abort();
+        /// Block until less than `limit` bytes given to Send() are still on their way to the socket,
+        /// so a producer faster than its client holds a bounded amount of memory; false once the
+        /// exchange is over. Never call it from an I/O thread, which is the one draining the data.
+        bool WaitBacklog(size_t limit);
+        /// Keep-alive chunks go out between complete messages only: turn them off while one is
+        /// being written in pieces, they would land in the middle of it
+        void KeepAlive(bool enabled) { keepAlive_ = enabled; }
+
+        /// The client is still there and the exchange is not over
+        bool IsOpen() const { return open_.load(); }
+        /// A response (complete or streamed) has been started
+        bool Responded() const { return state_.load() != State::Pending; }
+
+        /// Run on the I/O thread when the connection goes away before the exchange is over
+        void OnClose(std::function<void()> callback);
+        /// Run on the I/O thread when nothing was answered within the response timeout;
+        /// if the callback does not respond either, a 504 is sent
+        void OnTimeout(std::function<void()> callback);
+
+    private:
+        friend class HttpConnection;
+        enum class State : uint8_t { Pending, Streaming, Done };
+
+        void RunOnLoop(std::function<void(HttpConnection&)> task);
+        void Finished();
+        void Closed();
+        void TimedOut();
+        void Progress(size_t unsent);
+        void WakeWaiters();
+
+        HttpRequest request_;
+        std::weak_ptr<HttpConnection> connection_;
+        std::weak_ptr<HttpEventLoop> loop_;
+        std::atomic<State> state_ {State::Pending};
+        std::atomic<bool> open_ {true};
+        std::atomic<bool> keepAlive_ {true};
+
+        // Send() data not written to the socket yet: still queued for the I/O thread, then
+        // waiting in the connection output
+        std::atomic<size_t> queued_ {0};
+        std::atomic<size_t> unsent_ {0};
+        std::atomic<bool> waiting_ {false};
+        std::mutex backlog_mutex_;
+        std::condition_variable backlog_cv_;
+
+        std::mutex callbacks_mutex_;
+        std::function<void()> on_close_;
+        std::function<void()> on_timeout_;
+    };
+
+    /// Non-blocking HTTP/1.1 server: a fixed number of I/O threads, each running an
+    /// event loop (epoll on Linux, poll elsewhere) over its share of the connections.
+    /// Handlers run on the I/O threads and must not block; long work answers later
+    /// through the HttpExchange.
+    class HttpServer {
+    public:
+        using Handler = std::function<void(const std::shared_ptr<HttpExchange>&)>;
+
+        explicit HttpServer(size_t ioThreads = HTTP_IO_THREADS);
+        ~HttpServer();
+
+        HttpServer(const HttpServer&) = delete;
+        HttpServer& operator=(const HttpServer&) = delete;
+
+        /// Register before Listen(); path "*" matches every path
+        void Route(std::string method, std::string path, Handler handler);
+        /// Chunk written to streams that were silent for `interval`, which also detects dead clients
+        void StreamKeepAlive(std::string data, std::chrono::seconds interval);
+        void ResponseTimeout(std::chrono::seconds timeout) { responseTimeout_ = timeout; }
+
+        /// Bind, listen and start the I/O threads
+        bool Listen(const std::string& host, int port);
+        void Stop();
+        bool IsRunning() const { return running_.load(); }
+
+    private:
+        friend class HttpEventLoop;
+        friend class HttpConnection;
+
+        struct RouteEntry {
+            std::string method;
+            std::string path;
+            Handler handler;
+        };
+
+        const Handler* FindHandler(const HttpRequest& request, bool& pathFound) const;
+        HttpEventLoop& NextLoop();
+
+        size_t ioThreads_;
+        std::vector<RouteEntry> routes_;
+        std::string keepAliveData_;
+        std::chrono::seconds keepAliveInterval_ {0};
+        std::chrono::seconds responseTimeout_ {HTTP_RESPONSE_TIMEOUT_SECONDS};
+
+        std::vector<std::shared_ptr<HttpEventLoop>> loops_;
+        std::vector<std::thread> threads_;
+        std::atomic<size_t> nextLoop_ {0};
+        std::atomic<bool> running_ {false};
+        std::mutex lifecycle_mutex_;
+    };
+
+}
+
+#endif //MCP_SERVER_HTTP_SERVER_H
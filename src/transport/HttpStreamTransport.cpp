@@ -26,11 +26,20 @@
 
 #include "aixlog.hpp"
 #include "json.hpp"
+#include <chrono>
 
 namespace vx::transport {
 
-    HttpStream::HttpStream(int port, std::string host) : port_(port), host_(std::move(host)),
-        server_(std::make_unique<httplib::Server>()) {
+    namespace {
+        int64_t NowSeconds() {
+            return std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+    }
+
+    HttpStream::HttpStream(int port, std::string host, size_t ioThreads, size_t replayBytes) : port_(port), host_(std::move(host)),
+        replay_bytes_(replayBytes),
+        server_(std::make_unique<HttpServer>(ioThreads)) {
         SetupRoutes();
     }
 
@@ -43,19 +52,14 @@ namespace vx::transport {
             return false;
         }
 
-        server_running_.store(true);
-
-        server_thread_ = std::thread([this]() {
-            LOG(INFO) << "Starting HttpStream server on " << host_ << ":" << port_ << std::endl;
-
-            if (!server_->listen(host_.c_str(), port_)) {
-                LOG(ERROR) << "Failed to start HttpStream server on " << host_ << ":" << port_ << std::endl;
-                server_running_.store(false);
-            }
-        });
+        LOG(INFO) << "Starting HttpStream server on " << host_ << ":" << port_ << std::endl;
+        if (!server_->Listen(host_, port_)) {
+            LOG(ERROR) << "Failed to start HttpStream server on " << host_ << ":" << port_ << std::endl;
+            return false;
+        }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        return server_running_.load();
+        server_running_.store(true);
+        return true;
     }
 
     void HttpStream::Stop() {
@@ -64,33 +68,22 @@ namespace vx::transport {
         }
 
         server_running_.store(false);
-        client_connected_.store(false);
-        sse_stream_active_.store(false);
 
-        if (server_) {
-            server_->stop();
-        }
-
-        if (server_thread_.joinable()) {
-            server_thread_.join();
-        }
+        // closing the connections drops the pending requests and the SSE streams (see OnClose)
+        server_->Stop();
+        pending_.RemoveIf([](const PendingKey&, const PendingRequest&) { return true; });
+        sessions_.RemoveIf([](Session&) { return true; });
 
         incoming_cv_.notify_all();
-        sse_cv_.notify_all();
+    }
 
-        // Cancel any pending requests
-        {
-            std::lock_guard<std::mutex> lock(pending_mutex_);
-            for (auto& [id, pending] : pending_requests_) {
-                try {
-                    pending->promise.set_value("");
-                } catch (...) {}
-            }
-            pending_requests_.clear();
+    vx::InboundMessage HttpStream::Read() {
+        // the server is back for the next message: the previous one is dispatched
+        if (dispatching_) {
+            dispatching_->queued.fetch_sub(1, std::memory_order_release);
+            dispatching_.reset();
         }
-    }
 
-    std::pair<size_t, std::string> HttpStream::Read() {
         std::unique_lock<std::mutex> lock(incoming_mutex_);
 
         incoming_cv_.wait(lock, [this]() {
@@ -98,113 +91,240 @@ namespace vx::transport {
         });
 
         if (!server_running_.load() && incoming_messages_.empty()) {
-            return {0, ""};
+            return {};
         }
 
         if (!incoming_messages_.empty()) {
-            std::string message = incoming_messages_.front();
+            vx::InboundMessage message = std::move(incoming_messages_.front());
             incoming_messages_.pop();
-            return {message.length(), message};
+            dispatching_ = sessions_.Find(message.session);
+            return message;
         }
 
-        return {0, ""};
+        return {};
     }
 
-    void HttpStream::Write(const std::string& json_data) {
-        if (!client_connected_.load()) {
-            return;
+    bool HttpStream::RouteResponse(vx::OutboundMessage& message) {
+        // Responses are matched with the POST waiting for them by session and id,
+        // a batch reply carries the first id of its batch (see HandlePostMessage)
+        if (message.kind != vx::OutboundMessage::Kind::Response || !message.id.Valid()) {
+            return false;
         }
 
-        try {
-            auto parsed = nlohmann::json::parse(json_data);
-
-            // Check if this is a response to a pending request (has "id" and "result" or "error")
-            if (parsed.contains("id") && (parsed.contains("result") || parsed.contains("error"))) {
-                std::string id_str;
-                if (parsed["id"].is_number()) {
-                    id_str = std::to_string(parsed["id"].get<int>());
-                } else {
-                    id_str = parsed["id"].get<std::string>();
-                }
+        auto pending = pending_.Take({message.session, message.id});
+        if (!pending) {
+            return false;
+        }
+        pending->session->in_flight.fetch_sub(1, std::memory_order_relaxed);
+
+        LOG(DEBUG) << "Routing response to pending request id=" << message.id.ToString() << std::endl;
+        if (pending->streaming) {
+            // notifications went first on this response stream, the result closes it
+            if (!message.payload.empty()) {
+                std::string event = "event: message\ndata: ";
+                utils::ReplayRing::AppendData(event, message.payload);
+                pending->exchange->Send(std::move(event.append("\n\n")));
+            }
+            pending->exchange->End();
+        } else if (message.payload.empty()) {
+            RespondJson(pending->exchange, 500, "{\"error\":\"Internal server error\"}");
+        } else {
+            // the payload moves on into the exchange, it is not copied on its way to the socket
+            RespondJson(pending->exchange, 200, std::move(message.payload), pending->session->id);
+        }
+        return true;
+    }
 
-                std::lock_guard<std::mutex> lock(pending_mutex_);
-                auto it = pending_requests_.find(id_str);
-                if (it != pending_requests_.end()) {
-                    LOG(DEBUG) << "Routing response to pending request id=" << id_str << std::endl;
-                    it->second->promise.set_value(json_data);
-                    pending_requests_.erase(it);
-                    return;
-                }
+    bool HttpStream::StreamToRequest(const vx::OutboundMessage& message) {
+        // A notification sent while handling a request (e.g. progress) goes in-band, on the
+        // response of that request: the first one turns the pending POST into an SSE stream
+        if (message.kind != vx::OutboundMessage::Kind::Notification || !message.id.Valid()) {
+            return false;
+        }
+
+        // sent under the entry lock: once OpenStream() took the entry, no event can still get in
+        // between the pieces of the response
+        std::string event = "event: message\ndata: ";
+        utils::ReplayRing::AppendData(event, message.payload);
+        event.append("\n\n");
+        bool routed = false;
+        pending_.Visit({message.session, message.id}, [&](PendingRequest& pending) {
+            if (!pending.accepts_stream) return;
+            routed = true;
+            if (!std::exchange(pending.streaming, true)) {
+                auto headers = CORSHeaders();
+                headers.emplace_back("Content-Type", "text/event-stream");
+                headers.emplace_back("Cache-Control", "no-cache");
+                headers.emplace_back("Mcp-Session-Id", pending.session->id);
+                pending.exchange->StartStream(200, std::move(headers));
+            }
+            if (!pending.exchange->Send(std::move(event))) {
+                LOG(ERROR) << "SSE notification write failed" << std::endl;
+            }
+        });
+        if (routed) {
+            LOG(DEBUG) << "Sent notification on response stream (id=" << message.id.ToString() << "): " << message.payload << std::endl;
+        }
+        return routed;
+    }
+
+    // The body of a POST response (or its last SSE event, when notifications went first)
+    // written piece by piece, never more than HTTP_STREAM_BACKLOG ahead of the client
+    class HttpStream::ResponseStream : public vx::OutboundStream {
+    public:
+        ResponseStream(Exchange exchange, bool event) : exchange_(std::move(exchange)), event_(event) {}
+        ~ResponseStream() override { Close(); }
+
+        bool Write(std::string_view data) override {
+            if (closed_ || data.empty()) return !closed_ && exchange_->IsOpen();
+            std::string piece;
+            if (event_) {
+                utils::ReplayRing::AppendData(piece, data); // the piece goes in the data field
+            } else {
+                piece.assign(data);
+            }
+            return exchange_->Send(std::move(piece)) && exchange_->WaitBacklog(HTTP_STREAM_BACKLOG);
+        }
+
+        void Close() override {
+            if (std::exchange(closed_, true)) return;
+            if (event_) exchange_->Send("\n\n");
+            exchange_->End();
+        }
+
+        void Abort() override {
+            if (std::exchange(closed_, true)) return;
+            exchange_->Abort(); // no terminating chunk: the client sees the body broken off
+        }
+
+    private:
+        Exchange exchange_;
+        bool event_;
+        bool closed_ = false;
+    };
+
+    std::unique_ptr<vx::OutboundStream> HttpStream::OpenStream(uint64_t session, const vx::MessageId& id) {
+        auto pending = pending_.Take({session, id});
+        if (!pending) {
+            return nullptr;
+        }
+        pending->session->in_flight.fetch_sub(1, std::memory_order_relaxed);
+
+        LOG(DEBUG) << "Streaming response to pending request id=" << id.ToString() << std::endl;
+        const auto& exchange = pending->exchange;
+        exchange->KeepAlive(false);
+        if (pending->streaming) {
+            exchange->Send("event: message\ndata: ");
+        } else {
+            auto headers = CORSHeaders();
+            headers.emplace_back("Content-Type", "application/json");
+            headers.emplace_back("Mcp-Session-Id", pending->session->id);
+            exchange->StartStream(200, std::move(headers));
+        }
+        return std::make_unique<ResponseStream>(exchange, pending->streaming);
+    }
+
+    void HttpStream::SendEvents(uint64_t session, const std::vector<const std::string*>& payloads) {
+        if (payloads.empty()) return;
+
+        // every session numbers its own events: they are remembered for a reconnecting client,
+        // framed and taken for sending under the session lock, so they go out in id order.
+        // The sessions share one copy of each payload.
+        std::vector<utils::ReplayRing::Payload> shared;
+        shared.reserve(payloads.size());
+        for (const auto* payload : payloads) {
+            shared.push_back(std::make_shared<const std::string>(*payload));
+        }
+        std::vector<std::pair<Exchange, std::string>> sends;
+        auto frame = [&sends, &shared](const SessionPtr& target) {
+            std::lock_guard<std::mutex> lock(target->mutex);
+            if (!target->replay) return; // never opened a stream, nobody to send to or to replay for
+            std::string events;
+            std::string* out = target->stream ? &events : nullptr;
+            for (const auto& payload : shared) {
+                target->replay->Append(out, "message", payload);
             }
+            if (out) sends.emplace_back(target->stream, std::move(events));
+        };
+        // session 0 is the server speaking to everybody: every session gets a copy
+        if (session == 0) {
+            sessions_.ForEach(frame);
+        } else if (auto target = sessions_.Find(session)) {
+            frame(target);
+        }
 
-            // Server-initiated notification: queue for SSE stream
-            if (sse_stream_active_.load()) {
-                std::lock_guard<std::mutex> lock(sse_mutex_);
-                sse_notifications_.push(json_data);
-                sse_cv_.notify_one();
+        for (auto& [stream, events] : sends) {
+            if (!stream->Send(std::move(events))) {
+                LOG(ERROR) << "SSE notification write failed" << std::endl;
             }
-        } catch (const std::exception& e) {
-            LOG(ERROR) << "Error in Write: " << e.what() << std::endl;
         }
     }
 
-    std::future<std::pair<size_t, std::string>> HttpStream::ReadAsync() {
-        return std::async(std::launch::async, [this]() -> std::pair<size_t, std::string> {
-            return Read();
-        });
+    void HttpStream::Write(const vx::OutboundMessage& message) {
+        std::vector<vx::OutboundMessage> single {message};
+        WriteBatch(single);
     }
 
-    std::future<void> HttpStream::WriteAsync(const std::string& json_data) {
-        return std::async(std::launch::async, [this, json_data]() {
-            Write(json_data);
-        });
+    void HttpStream::WriteBatch(std::vector<vx::OutboundMessage>& messages) {
+        // gather the notifications of each session and hand them to its stream in one chunk
+        std::unordered_map<uint64_t, std::vector<const std::string*>> events;
+        for (auto& message : messages) {
+            if (!RouteResponse(message) && !StreamToRequest(message)) {
+                LOG(DEBUG) << "Sending SSE notification: " << message.payload << std::endl;
+                events[message.session].push_back(&message.payload);
+            }
+        }
+
+        for (const auto& [session, payloads] : events) {
+            SendEvents(session, payloads);
+        }
     }
 
     void HttpStream::SetupRoutes() {
-        server_->Options("/.*", [](const httplib::Request& req, httplib::Response& res) {
-            HandleOptionsRequest(req, res);
+        server_->Route("OPTIONS", "*", [](const Exchange& exchange) {
+            HandleOptionsRequest(exchange);
         });
 
-        server_->Get("/health", [](const httplib::Request& req, httplib::Response& res) {
-            res.set_content("{\"status\":\"ok\"}", "application/json");
+        server_->Route("GET", "/health", [](const Exchange& exchange) {
+            exchange->Respond(200, {{"Content-Type", "application/json"}}, "{\"status\":\"ok\"}");
         });
 
-        server_->Post("/mcp", [this](const httplib::Request& req, httplib::Response& res) {
-            HandlePostMessage(req, res);
+        server_->Route("POST", "/mcp", [this](const Exchange& exchange) {
+            HandlePostMessage(exchange);
         });
 
-        server_->Get("/mcp", [this](const httplib::Request& req, httplib::Response& res) {
-            HandleGetSSE(req, res);
+        server_->Route("GET", "/mcp", [this](const Exchange& exchange) {
+            HandleGetSSE(exchange);
         });
 
-        server_->Delete("/mcp", [this](const httplib::Request& req, httplib::Response& res) {
-            HandleDeleteSession(req, res);
+        server_->Route("DELETE", "/mcp", [this](const Exchange& exchange) {
+            HandleDeleteSession(exchange);
         });
+
+        // keep-alive comment on silent SSE streams, a failing write detects a gone client
+        server_->StreamKeepAlive(": ping\n\n", std::chrono::seconds(15));
     }
 
-    void HttpStream::HandlePostMessage(const httplib::Request& req, httplib::Response& res) {
-        SetCORSHeaders(res);
+    void HttpStream::HandlePostMessage(const Exchange& exchange) {
+        const HttpRequest& req = exchange->Request();
 
         // Validate Content-Type
-        auto content_type = req.get_header_value("Content-Type");
+        auto content_type = req.Header("Content-Type");
         if (content_type.find("application/json") == std::string::npos) {
-            res.status = 415;
-            res.set_content("{\"error\":\"Unsupported Media Type. Expected application/json\"}", "application/json");
+            RespondJson(exchange, 415, "{\"error\":\"Unsupported Media Type. Expected application/json\"}");
             return;
         }
 
         // Validate Accept header: client must accept application/json and optionally text/event-stream
-        auto accept = req.get_header_value("Accept");
+        auto accept = req.Header("Accept");
         if (!accept.empty() && accept.find("application/json") == std::string::npos) {
-            res.status = 406;
-            res.set_content("{\"error\":\"Not Acceptable. Must accept application/json\"}", "application/json");
+            RespondJson(exchange, 406, "{\"error\":\"Not Acceptable. Must accept application/json\"}");
             return;
         }
 
-        std::string message = req.body;
+        std::string message = exchange->TakeBody(); // the bytes received travel on to the plugins
         if (message.empty()) {
-            res.status = 400;
-            res.set_content("{\"error\":\"Empty message body\"}", "application/json");
+            RespondJson(exchange, 400, "{\"error\":\"Empty message body\"}");
             return;
         }
 
@@ -212,229 +332,284 @@ namespace vx::transport {
         try {
             parsed = nlohmann::json::parse(message);
         } catch (const nlohmann::json::parse_error& e) {
-            res.status = 400;
-            res.set_content("{\"error\":\"Invalid JSON\"}", "application/json");
+            RespondJson(exchange, 400, "{\"error\":\"Invalid JSON\"}");
             return;
         }
 
+        EvictIdleSessions();
+
         // Check if this is the initialize request (first message, no session required)
-        bool is_initialize = parsed.contains("method") && parsed["method"] == "initialize";
+        bool is_initialize = parsed.is_object() && parsed.contains("method") && parsed["method"] == "initialize";
 
+        SessionPtr session;
         if (is_initialize) {
-            // Generate session ID on initialize
-            session_id_ = vx::utils::SessionBuilder::GenerateUniqueSessionID();
-            session_initialized_ = true;
-            client_connected_.store(true);
-            LOG(INFO) << "Session initialized: " << session_id_ << std::endl;
-        } else if (session_initialized_) {
+            // every initialize opens a new session, the clients already connected keep theirs
+            session = sessions_.Create();
+            Touch(*session);
+            LOG(INFO) << "Session initialized: " << session->id << " (" << sessions_.Size() << " active)" << std::endl;
+        } else {
             // Validate session for non-initialize requests
-            if (!ValidateSession(req, res)) {
+            session = FindSession(exchange);
+            if (!session) {
                 return;
             }
         }
 
-        // Check if this is a notification (no "id" field) or a request (has "id" field)
-        bool is_notification = !parsed.contains("id");
+        // Check if this is a notification (no "id" field) or a request (has "id" field).
+        // A batch is answered by one array, expected only if some element carries an id.
+        vx::MessageId id = vx::MessageId::Of(parsed);
+        bool is_notification = !id.Valid();
+
+        // the event loop must not block: whatever may wait on a plugin goes through the server queues,
+        // and so does what comes after it until the server took it, to keep the session's order
+        if (request_handler_ && !parsed.is_array() && runs_inline_(parsed) &&
+            session->queued.load(std::memory_order_acquire) == 0) {
+            RunInline(exchange, session, std::move(message), std::move(parsed));
+            return;
+        }
 
         if (is_notification) {
             // Queue the notification for the server to process
             LOG(DEBUG) << "Received notification via POST: " << message << std::endl;
             {
                 std::lock_guard<std::mutex> lock(incoming_mutex_);
-                incoming_messages_.push(message);
+                session->queued.fetch_add(1, std::memory_order_relaxed);
+                incoming_messages_.emplace(std::move(message), std::move(parsed), session->token);
             }
             incoming_cv_.notify_one();
 
             // Notifications get 202 Accepted
-            res.status = 202;
-            if (session_initialized_) {
-                res.set_header("Mcp-Session-Id", session_id_);
-            }
+            auto headers = CORSHeaders();
+            headers.emplace_back("Mcp-Session-Id", session->id);
+            exchange->Respond(202, std::move(headers));
             return;
         }
 
-        // This is a request - we need to wait for the response from the Server
-        std::string id_str;
-        if (parsed["id"].is_number()) {
-            id_str = std::to_string(parsed["id"].get<int>());
-        } else {
-            id_str = parsed["id"].get<std::string>();
-        }
-
-        LOG(DEBUG) << "Received request via POST (id=" << id_str << "): " << message << std::endl;
-
-        // Create a pending request with a promise/future pair
-        auto pending = std::make_shared<PendingRequest>();
-        std::future<std::string> response_future = pending->promise.get_future();
+        // This is a request: the exchange stays open until Write() routes the response to it
+        LOG(DEBUG) << "Received request via POST (id=" << id.ToString() << "): " << message << std::endl;
 
-        {
-            std::lock_guard<std::mutex> lock(pending_mutex_);
-            pending_requests_[id_str] = pending;
+        // counted before it is visible, the response may be routed before Insert() even returns
+        PendingKey key {session->token, id};
+        session->in_flight.fetch_add(1, std::memory_order_relaxed);
+        bool accepts_stream = accept.find("text/event-stream") != std::string::npos;
+        if (!pending_.Insert(key, {exchange, session, accepts_stream})) {
+            session->in_flight.fetch_sub(1, std::memory_order_relaxed);
+            RespondJson(exchange, 409, "{\"error\":\"Request id already in flight\"}", session->id);
+            return;
         }
 
-        // Queue the message for the Server to process via Read()
+        // drop the pending entry if the client goes away, answer 504 if the server never does
+        std::weak_ptr<HttpExchange> weak = exchange;
+        auto forget = [this, key, weak]() {
+            auto exchange = weak.lock();
+            auto pending = pending_.TakeIf(key, [&exchange](const PendingRequest& pending) {
+                return pending.exchange == exchange;
+            });
+            if (pending) {
+                pending->session->in_flight.fetch_sub(1, std::memory_order_relaxed);
+                Touch(*pending->session);
+            }
+        };
+        exchange->OnClose(forget);
+        exchange->OnTimeout([forget, weak, key]() {
+            LOG(ERROR) << "Request timed out (id=" << key.id.ToString() << ")" << std::endl;
+            forget();
+            if (auto timed_out = weak.lock()) {
+                RespondJson(timed_out, 504, "{\"error\":\"Request timed out\"}");
+            }
+        });
+
+        // Queue the message for the Server to process via Read(); the DOM travels
+        // with it so the server does not parse the body a second time
         {
             std::lock_guard<std::mutex> lock(incoming_mutex_);
-            incoming_messages_.push(message);
+            session->queued.fetch_add(1, std::memory_order_relaxed);
+            incoming_messages_.emplace(std::move(message), std::move(parsed), session->token);
         }
         incoming_cv_.notify_one();
+    }
 
-        // Wait for the Server to process and call Write() with the response
-        auto status = response_future.wait_for(std::chrono::seconds(30));
-        if (status == std::future_status::timeout) {
-            LOG(ERROR) << "Request timed out (id=" << id_str << ")" << std::endl;
-            // Clean up the pending request
-            {
-                std::lock_guard<std::mutex> lock(pending_mutex_);
-                pending_requests_.erase(id_str);
-            }
-            res.status = 504;
-            res.set_content("{\"error\":\"Request timed out\"}", "application/json");
-            return;
+    void HttpStream::RunInline(const Exchange& exchange, const SessionPtr& session, std::string message, nlohmann::json parsed) {
+        // no queue, no other thread: the server handles the message here and the answer
+        // goes out on this connection; the I/O thread is busy until the handler returns
+        LOG(DEBUG) << "Handling message inline: " << message << std::endl;
+        bool is_request = vx::MessageId::Of(parsed).Valid();
+        std::string response = request_handler_(vx::InboundMessage(std::move(message), std::move(parsed), session->token));
+        Touch(*session);
+
+        if (!is_request) {
+            auto headers = CORSHeaders();
+            headers.emplace_back("Mcp-Session-Id", session->id);
+            exchange->Respond(202, std::move(headers));
+        } else if (response.empty()) {
+            RespondJson(exchange, 500, "{\"error\":\"Internal server error\"}", session->id);
+        } else {
+            RespondJson(exchange, 200, std::move(response), session->id);
         }
+    }
 
-        std::string response_data = response_future.get();
-        if (response_data.empty()) {
-            res.status = 500;
-            res.set_content("{\"error\":\"Internal server error\"}", "application/json");
+    void HttpStream::HandleGetSSE(const Exchange& exchange) {
+        // Validate session
+        SessionPtr session = FindSession(exchange);
+        if (!session) {
             return;
         }
 
-        res.status = 200;
-        res.set_content(response_data, "application/json");
-        if (session_initialized_) {
-            res.set_header("Mcp-Session-Id", session_id_);
-        }
-    }
+        auto last_event_id = exchange->Request().Header("Last-Event-ID");
+        LOG(DEBUG) << "SSE stream client connected (session " << session->id << ")"
+                   << (last_event_id.empty() ? "" : ", resuming after event " + last_event_id) << std::endl;
 
-    void HttpStream::HandleGetSSE(const httplib::Request& req, httplib::Response& res) {
-        SetCORSHeaders(res);
+        auto headers = CORSHeaders();
+        headers.emplace_back("Content-Type", "text/event-stream");
+        headers.emplace_back("Cache-Control", "no-cache");
+        headers.emplace_back("Mcp-Session-Id", session->id);
 
-        // Validate session
-        if (session_initialized_ && !ValidateSession(req, res)) {
-            return;
+        // Start the stream and catch up on what the client missed under the session lock, so no
+        // new event can overtake the replayed ones. No OnClose is registered yet: nothing called
+        // inline from here can come back for the lock.
+        Exchange previous;
+        {
+            std::lock_guard<std::mutex> lock(session->mutex);
+            if (!session->replay) {
+                session->replay = std::make_unique<utils::ReplayRing>(replay_bytes_);
+            }
+            exchange->StartStream(200, std::move(headers));
+            if (!last_event_id.empty()) {
+                std::string missed;
+                if (!session->replay->Replay(utils::ReplayRing::ParseId(last_event_id), missed)) {
+                    LOG(WARNING) << "Some events after " << last_event_id << " are gone, replaying what is left" << std::endl;
+                }
+                if (!missed.empty()) {
+                    exchange->Send(std::move(missed));
+                }
+            }
+            previous = std::exchange(session->stream, exchange);
         }
 
-        LOG(DEBUG) << "SSE stream client connected" << std::endl;
-
-        res.set_header("Content-Type", "text/event-stream");
-        res.set_header("Cache-Control", "no-cache");
-        res.set_header("Connection", "keep-alive");
-        if (session_initialized_) {
-            res.set_header("Mcp-Session-Id", session_id_);
-        }
-
-        sse_stream_active_.store(true);
-
-        res.set_content_provider(
-            "text/event-stream",
-            [this](size_t offset, httplib::DataSink& sink) -> bool {
-                using clock = std::chrono::steady_clock;
-                static thread_local auto last_ping = clock::now();
-                const auto ping_interval = std::chrono::seconds(15);
-
-                auto terminate = [this]() -> bool {
-                    sse_stream_active_.store(false);
-                    sse_cv_.notify_all();
-                    return false;
-                };
-
-                try {
-                    // Keep-alive ping
-                    if (clock::now() - last_ping >= ping_interval) {
-                        const char* ping = ": ping\n\n";
-                        if (!sink.write(ping, std::strlen(ping))) {
-                            LOG(ERROR) << "SSE keep-alive write failed" << std::endl;
-                            return terminate();
-                        }
-                        last_ping = clock::now();
-                    }
-
-                    // Wait for notifications
-                    std::unique_lock<std::mutex> lock(sse_mutex_);
-                    sse_cv_.wait_for(lock, std::chrono::milliseconds(200), [this]() {
-                        return !sse_notifications_.empty() || !sse_stream_active_.load();
-                    });
-
-                    if (!sse_stream_active_.load()) {
-                        return terminate();
-                    }
-
-                    if (!sse_notifications_.empty()) {
-                        std::string message = sse_notifications_.front();
-                        sse_notifications_.pop();
-                        lock.unlock();
-
-                        std::string sse_msg = "event: message\ndata: " + message + "\n\n";
-                        LOG(DEBUG) << "Sending SSE notification: " << message << std::endl;
-
-                        if (!sink.write(sse_msg.data(), sse_msg.size())) {
-                            LOG(ERROR) << "SSE notification write failed" << std::endl;
-                            return terminate();
-                        }
-                    }
-
-                    return true;
-                } catch (const std::exception& ex) {
-                    LOG(ERROR) << "Exception in SSE content provider: " << ex.what() << std::endl;
-                    return terminate();
-                } catch (...) {
-                    LOG(ERROR) << "Unknown exception in SSE content provider" << std::endl;
-                    return terminate();
-                }
+        // the stream holds no thread: notifications are pushed to it by Write()
+        std::weak_ptr<Session> weak_session = session;
+        std::weak_ptr<HttpExchange> weak = exchange;
+        auto disconnected = [weak_session, weak]() {
+            LOG(DEBUG) << "SSE stream client disconnected" << std::endl;
+            auto owner = weak_session.lock();
+            if (!owner) return;
+            std::lock_guard<std::mutex> lock(owner->mutex);
+            if (owner->stream == weak.lock()) {
+                owner->stream.reset();
             }
-        );
-    }
+            Touch(*owner);
+        };
+        exchange->OnClose(disconnected);
+        if (!exchange->IsOpen()) {
+            disconnected(); // gone before OnClose was in place
+        }
 
-    void HttpStream::HandleDeleteSession(const httplib::Request& req, httplib::Response& res) {
-        SetCORSHeaders(res);
+        // a new stream replaces the previous one of the session; callbacks may run inline, so end it unlocked
+        if (previous) {
+            previous->End();
+        }
+    }
 
-        if (!session_initialized_) {
-            res.status = 404;
-            res.set_content("{\"error\":\"No active session\"}", "application/json");
+    void HttpStream::HandleDeleteSession(const Exchange& exchange) {
+        SessionPtr session = FindSession(exchange);
+        if (!session) {
             return;
         }
 
-        if (!ValidateSession(req, res)) {
-            return;
+        LOG(INFO) << "Session terminated by client: " << session->id << std::endl;
+
+        sessions_.Remove(session->token);
+        CloseSession(session);
+
+        RespondJson(exchange, 200, "{\"status\":\"session terminated\"}");
+    }
+
+    HttpStream::SessionPtr HttpStream::FindSession(const Exchange& exchange) {
+        auto client_session = exchange->Request().Header("Mcp-Session-Id");
+        if (client_session.empty()) {
+            LOG(ERROR) << "Missing session ID" << std::endl;
+            RespondJson(exchange, 400, "{\"error\":\"Missing session ID\"}");
+            return nullptr;
         }
 
-        LOG(INFO) << "Session terminated by client: " << session_id_ << std::endl;
+        SessionPtr session = sessions_.Find(client_session);
+        if (!session) {
+            LOG(ERROR) << "Invalid session ID: " << client_session << std::endl;
+            RespondJson(exchange, 404, "{\"error\":\"Invalid or missing session ID\"}");
+            return nullptr;
+        }
 
-        session_initialized_ = false;
-        client_connected_.store(false);
-        sse_stream_active_.store(false);
+        Touch(*session);
+        return session;
+    }
 
-        // Wake up any blocked Read() calls
-        incoming_cv_.notify_all();
-        sse_cv_.notify_all();
+    void HttpStream::Touch(Session& session) {
+        session.last_active.store(NowSeconds(), std::memory_order_relaxed);
+    }
 
-        res.status = 200;
-        res.set_content("{\"status\":\"session terminated\"}", "application/json");
+    void HttpStream::CloseSession(const SessionPtr& session) {
+        // the session is out of the table already: end its stream and its waiting POSTs unlocked
+        Exchange stream;
+        {
+            std::lock_guard<std::mutex> lock(session->mutex);
+            stream = std::move(session->stream);
+        }
+        if (stream) {
+            stream->End();
+        }
+
+        if (session->in_flight.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+        auto pending = pending_.RemoveIf([token = session->token](const PendingKey& key, const PendingRequest&) {
+            return key.session == token;
+        });
+        for (auto& [key, waiting] : pending) {
+            session->in_flight.fetch_sub(1, std::memory_order_relaxed);
+            RespondJson(waiting.exchange, 404, "{\"error\":\"Session terminated\"}");
+        }
     }
 
-    bool HttpStream::ValidateSession(const httplib::Request& req, httplib::Response& res) const {
-        auto client_session = req.get_header_value("Mcp-Session-Id");
-        if (client_session.empty() || client_session != session_id_) {
-            LOG(ERROR) << "Invalid session ID: " << client_session << " (expected: " << session_id_ << ")" << std::endl;
-            res.status = 404;
-            res.set_content("{\"error\":\"Invalid or missing session ID\"}", "application/json");
-            return false;
+    void HttpStream::EvictIdleSessions() {
+        // a sweep at most every HTTP_SESSION_SWEEP_SECONDS, run by whoever gets here first
+        int64_t now = NowSeconds();
+        int64_t last = last_sweep_.load(std::memory_order_relaxed);
+        if (now - last < HTTP_SESSION_SWEEP_SECONDS || !last_sweep_.compare_exchange_strong(last, now)) {
+            return;
+        }
+
+        // only sessions nobody is using: no stream open, no request in flight
+        auto evicted = sessions_.RemoveIf([now](Session& session) {
+            std::lock_guard<std::mutex> lock(session.mutex);
+            return (!session.stream || !session.stream->IsOpen()) && session.in_flight.load(std::memory_order_relaxed) == 0 &&
+                   now - session.last_active.load(std::memory_order_relaxed) > HTTP_SESSION_IDLE_SECONDS;
+        });
+        for (const auto& session : evicted) {
+            LOG(INFO) << "Session expired: " << session->id << std::endl;
         }
-        return true;
     }
 
-    void HttpStream::HandleOptionsRequest(const httplib::Request& req, httplib::Response& res) {
-        SetCORSHeaders(res);
-        res.status = 200;
+    void HttpStream::HandleOptionsRequest(const Exchange& exchange) {
+        exchange->Respond(200, CORSHeaders());
+    }
+
+    void HttpStream::RespondJson(const Exchange& exchange, int status, std::string body, const std::string& session) {
+        auto headers = CORSHeaders();
+        headers.emplace_back("Content-Type", "application/json");
+        if (!session.empty()) {
+            headers.emplace_back("Mcp-Session-Id", session);
+        }
+        exchange->Respond(status, std::move(headers), std::move(body));
     }
 
-    void HttpStream::SetCORSHeaders(httplib::Response& res) {
-        res.set_header("Access-Control-Allow-Origin", "*");
-        res.set_header("Access-Control-Allow-Methods", "GET, POST, DELETE, OPTIONS");
-        res.set_header("Access-Control-Allow-Headers", "Content-Type, Authorization, Mcp-Session-Id");
-        res.set_header("Access-Control-Expose-Headers", "Content-Type, Mcp-Session-Id");
-        res.set_header("Access-Control-Max-Age", "86400");
+    HttpHeaders HttpStream::CORSHeaders() {
+        return {
+            {"Access-Control-Allow-Origin", "*"},
+            {"Access-Control-Allow-Methods", "GET, POST, DELETE, OPTIONS"},
+            {"Access-Control-Allow-Headers", "Content-Type, Authorization, Mcp-Session-Id"},
+            {"Access-Control-Expose-Headers", "Content-Type, Mcp-Session-Id"},
+            {"Access-Control-Max-Age", "86400"}
+        };
     }
 
 }
@@ -25,21 +25,28 @@
 #ifndef MCP_SERVER_HTTP_STREAM_TRANSPORT_HPP
 #define MCP_SERVER_HTTP_STREAM_TRANSPORT_HPP
 #include "ITransport.h"
-#include "httplib.h"
+#include "HttpServer.h"
+#include "json.hpp"
 #include <memory>
 #include <atomic>
 #include <queue>
 #include <mutex>
 #include <condition_variable>
-#include <thread>
 #include <unordered_map>
-#include "utils/SessionBuilder.h"
+#include "utils/SessionTable.h"
+#include "utils/PendingTable.h"
+#include "utils/ReplayRing.h"
+
+#define HTTP_SESSION_IDLE_SECONDS (30 * 60)
+#define HTTP_SESSION_SWEEP_SECONDS 60
+#define HTTP_STREAM_BACKLOG (1024 * 1024)
 
 namespace vx::transport {
 
     class HttpStream : public vx::ITransport {
     public:
-        explicit HttpStream(int port = 8080, std::string host = "127.0.0.1");
+        explicit HttpStream(int port = 8080, std::string host = "127.0.0.1", size_t ioThreads = HTTP_IO_THREADS,
+                            size_t replayBytes = SSE_REPLAY_BYTES);
         ~HttpStream();
 
         HttpStream(const HttpStream&) = delete;
@@ -53,58 +60,86 @@ namespace vx::transport {
 
         bool IsRunning() override { return server_running_.load(); }
 
-        std::pair<size_t, std::string> Read() override;
+        vx::InboundMessage Read() override;
+
+        void Write(const vx::OutboundMessage& message) override;
 
-        void Write(const std::string &json_data) override;
+        void WriteBatch(std::vector<vx::OutboundMessage>& messages) override;
 
-        std::future<std::pair<size_t, std::string>> ReadAsync() override;
+        std::unique_ptr<vx::OutboundStream> OpenStream(uint64_t session, const vx::MessageId& id) override;
 
-        std::future<void> WriteAsync(const std::string &json_data) override;
+        bool RunToCompletion(RequestHandler handler, InlineFilter runs_inline) override {
+            request_handler_ = std::move(handler);
+            runs_inline_ = std::move(runs_inline);
+            return true;
+        }
 
         std::string GetName() override { return "httpstream"; }
 
-        std::string GetVersion() override { return "0.1"; }
+        std::string GetVersion() override { return "0.4"; }
 
         int GetPort() override { return port_; }
 
     private:
-        void SetupRoutes();
-        void HandlePostMessage(const httplib::Request& req, httplib::Response& res);
-        void HandleGetSSE(const httplib::Request& req, httplib::Response& res);
-        void HandleDeleteSession(const httplib::Request& req, httplib::Response& res);
-        static void HandleOptionsRequest(const httplib::Request& req, httplib::Response& res);
-        static void SetCORSHeaders(httplib::Response& res);
+        using Exchange = std::shared_ptr<HttpExchange>;
+        class ResponseStream;
+
+        // One client of the transport: its notification stream and how many of its POSTs are waiting
+        struct Session {
+            std::string id;
+            uint64_t token = 0;
+            std::mutex mutex;
+            Exchange stream;
+            std::unique_ptr<utils::ReplayRing> replay; // numbers the stream events, from the first GET on
+            std::atomic<size_t> in_flight {0};
+            std::atomic<size_t> queued {0};    // messages the server has not taken from Read() yet
+            std::atomic<int64_t> last_active {0};
+        };
+        using SessionPtr = std::shared_ptr<Session>;
+
+        // A POST waiting for its response
+        using PendingKey = utils::PendingKey;
+        using PendingRequest = utils::PendingRequest<HttpExchange, Session>;
 
-        bool ValidateSession(const httplib::Request& req, httplib::Response& res) const;
+        void SetupRoutes();
+        void HandlePostMessage(const Exchange& exchange);
+        void HandleGetSSE(const Exchange& exchange);
+        void HandleDeleteSession(const Exchange& exchange);
+        static void HandleOptionsRequest(const Exchange& exchange);
+        static HttpHeaders CORSHeaders();
+        static void RespondJson(const Exchange& exchange, int status, std::string body, const std::string& session = {});
+
+        SessionPtr FindSession(const Exchange& exchange);
+        static void Touch(Session& session);
+        void CloseSession(const SessionPtr& session);
+        void EvictIdleSessions();
+        bool RouteResponse(vx::OutboundMessage& message);
+        bool StreamToRequest(const vx::OutboundMessage& message);
+        void RunInline(const Exchange& exchange, const SessionPtr& session, std::string message, nlohmann::json parsed);
+        void SendEvents(uint64_t session, const std::vector<const std::string*>& payloads);
 
         int port_;
         std::string host_;
-        std::unique_ptr<httplib::Server> server_;
-        std::thread server_thread_;
+        size_t replay_bytes_;
+        std::unique_ptr<HttpServer> server_;
         std::atomic<bool> server_running_ {false};
-        std::atomic<bool> client_connected_ {false};
 
-        // Session management
-        std::string session_id_;
-        bool session_initialized_ {false};
+        // Session management: one entry per initialized client, keyed by Mcp-Session-Id
+        utils::SessionTable<Session> sessions_;
+        std::atomic<int64_t> last_sweep_ {0};
+
+        // POSTs waiting for their response: nothing blocks, the exchange is answered by Write()
+        utils::PendingTable<HttpExchange, Session> pending_;
+
+        // Run-to-completion: requests answered on the I/O thread that received them
+        RequestHandler request_handler_;
+        InlineFilter runs_inline_;
 
         // Incoming message queue (client -> server, consumed by Read())
-        std::queue<std::string> incoming_messages_;
+        std::queue<vx::InboundMessage> incoming_messages_;
         std::mutex incoming_mutex_;
         std::condition_variable incoming_cv_;
-
-        // Pending request responses: maps request id (string) -> response string
-        struct PendingRequest {
-            std::promise<std::string> promise;
-        };
-        std::unordered_map<std::string, std::shared_ptr<PendingRequest>> pending_requests_;
-        std::mutex pending_mutex_;
-
-        // SSE stream for server-initiated notifications (GET /mcp)
-        std::queue<std::string> sse_notifications_;
-        std::mutex sse_mutex_;
-        std::condition_variable sse_cv_;
-        std::atomic<bool> sse_stream_active_ {false};
+        SessionPtr dispatching_; // of the last message Read() returned, only touched by the reader
     };
 
 }
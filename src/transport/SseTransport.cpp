@@ -33,18 +33,24 @@
 
 #include "SseTransport.h"
 
-#include <iostream>
-#include <httplib.h>
 #include <chrono>
 #include <utility>
-#include <iomanip>
 
 #include "aixlog.hpp"
 #include "json.hpp"
 
 namespace vx::transport {
 
-    SSE::SSE(const int port, std::string host) : host_(std::move(host)), port_(port), server_(std::make_unique<httplib::Server>()) {
+    namespace {
+        int64_t NowSeconds() {
+            return std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+    }
+
+    SSE::SSE(const int port, std::string host, size_t ioThreads, size_t replayBytes) : host_(std::move(host)), port_(port),
+        replay_bytes_(replayBytes),
+        server_(std::make_unique<HttpServer>(ioThreads)) {
         SetupRoutes();
     }
 
@@ -52,58 +58,80 @@ namespace vx::transport {
         SSE::Stop();
     }
 
-    std::pair<size_t, std::string> SSE::Read() {
+    vx::InboundMessage SSE::Read() {
         std::unique_lock<std::mutex> lock(incoming_mutex_);
 
-        LOG(TRACE) << "WAITING FOR LOCK TO BE RELEASED" << std::endl;
-        LOG(TRACE) << "incoming_messages_: " << incoming_messages_.empty() << std::endl;
-        LOG(TRACE) << "server_running: " << server_running_.load() << std::endl;
-
         incoming_cv_.wait(lock, [this]() {
             return !incoming_messages_.empty() || !server_running_.load();
         });
 
-        LOG(TRACE) << "LOCK RELEASED" << std::endl;
-
         if (!server_running_.load() && incoming_messages_.empty()) {
-            return {0, ""};
+            return {};
         }
 
         if (!incoming_messages_.empty()) {
-            std::string message = incoming_messages_.front();
+            vx::InboundMessage message = std::move(incoming_messages_.front());
             incoming_messages_.pop();
-            return { message.length(), message };
+            return message;
         } else {
-            return {0, ""};
+            return {};
         }
     }
 
-    void SSE::Write(const std::string& json_data) {
-        LOG(TRACE) << "RequestHandler delegated = " << json_data << std::endl;
-        LOG(TRACE) << "is_client_connected = " << client_connected_.load() << std::endl;
-        if (!client_connected_.load()) {
-            return;
-        }
+    void SSE::SendEvents(uint64_t session, const std::vector<const std::string*>& payloads) {
+        if (payloads.empty()) return;
 
-        {
-            std::lock_guard<std::mutex> lock(outgoing_mutex_);
-            outgoing_messages_.push(json_data);
+        // number and remember everything, even while the client is away: coming back with
+        // Last-Event-ID it gets it then. Framed and picked up under the session lock, so the
+        // events of a session go out in id order. The sessions share one copy of each payload.
+        std::vector<utils::ReplayRing::Payload> shared;
+        shared.reserve(payloads.size());
+        for (const auto* payload : payloads) {
+            shared.push_back(std::make_shared<const std::string>(*payload));
+        }
+        std::vector<std::pair<Exchange, std::string>> sends;
+        auto frame = [this, &sends, &shared](const SessionPtr& target) {
+            std::lock_guard<std::mutex> lock(target->mutex);
+            if (!target->replay) {
+                target->replay = std::make_unique<utils::ReplayRing>(replay_bytes_);
+            }
+            std::string events;
+            std::string* out = target->stream ? &events : nullptr;
+            for (const auto& payload : shared) {
+                target->replay->Append(out, {}, payload);
+            }
+            if (out) sends.emplace_back(target->stream, std::move(events));
+        };
+        // session 0 is the server speaking to everybody: every client gets a copy
+        if (session == 0) {
+            sessions_.ForEach(frame);
+        } else if (auto target = sessions_.Find(session)) {
+            frame(target);
         }
 
-        outgoing_cv_.notify_one();
+        for (auto& [stream, events] : sends) {
+            if (!stream->Send(std::move(events))) {
+                LOG(ERROR) << "Failed to write SSE message(s); client disconnected" << std::endl;
+            }
+        }
     }
 
-    std::future<std::pair<size_t, std::string>> SSE::ReadAsync() {
-        return std::async(std::launch::async, [this]() -> std::pair<size_t, std::string> {
-            LOG(TRACE) << "READ ASYNC CALLED!!!" << std::endl;
-            return Read();
-        });
+    void SSE::Write(const vx::OutboundMessage& message) {
+        std::vector<vx::OutboundMessage> single {message};
+        WriteBatch(single);
     }
 
-    std::future<void> SSE::WriteAsync(const std::string& json_data) {
-        return std::async(std::launch::async, [this, json_data] () {
-            Write(json_data);
-        });
+    void SSE::WriteBatch(std::vector<vx::OutboundMessage>& messages) {
+        // gather the messages of each client and hand them to its stream in one chunk
+        std::unordered_map<uint64_t, std::vector<const std::string*>> events;
+        for (const auto& message : messages) {
+            LOG(DEBUG) << "Sending SSE message: " << message.payload << std::endl;
+            events[message.session].push_back(&message.payload);
+        }
+
+        for (const auto& [session, payloads] : events) {
+            SendEvents(session, payloads);
+        }
     }
 
     bool SSE::Start() {
@@ -111,19 +139,14 @@ namespace vx::transport {
             return false;
         }
 
-        server_running_.store(true);
-
-        server_thread_ = std::thread([this]() {
-            LOG(INFO) << "Starting SSE server on " << host_ << ":" << port_ << std::endl;
-
-            if (!server_->listen(host_.c_str(), port_)) {
-                LOG(ERROR) << "Failed to start SSE server on " << host_ << ":" << port_ << std::endl;
-                server_running_.store(false);
-            }
-        });
+        LOG(INFO) << "Starting SSE server on " << host_ << ":" << port_ << std::endl;
+        if (!server_->Listen(host_, port_)) {
+            LOG(ERROR) << "Failed to start SSE server on " << host_ << ":" << port_ << std::endl;
+            return false;
+        }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        return server_running_.load();
+        server_running_.store(true);
+        return true;
     }
 
     void SSE::Stop() {
@@ -132,40 +155,36 @@ namespace vx::transport {
         }
 
         server_running_.store(false);
-        client_connected_.store(false);
-        sse_active_.store(false);
 
-        if (server_) {
-            server_->stop();
-        }
-
-        if (server_thread_.joinable()) {
-            server_thread_.join();
-        }
+        server_->Stop();
+        sessions_.RemoveIf([](Session&) { return true; });
 
         incoming_cv_.notify_all();
-        outgoing_cv_.notify_all();
     }
 
     void SSE::SetupRoutes() {
-        server_->Options("/.*", [this](const httplib::Request& req, httplib::Response& res) {
-            HandleOptionsRequest(req, res);
+        server_->Route("OPTIONS", "*", [](const Exchange& exchange) {
+            HandleOptionsRequest(exchange);
         });
 
-        server_->Get("/health", [](const httplib::Request& req, httplib::Response& res) {
-            res.set_content("{\"status\" : \"ok\"}", "application/json");
+        server_->Route("GET", "/health", [](const Exchange& exchange) {
+            exchange->Respond(200, {{"Content-Type", "application/json"}}, "{\"status\" : \"ok\"}");
         });
 
-        server_->Post("/messages", [this](const httplib::Request& req, httplib::Response& res) {
-            HandlePostMessage(req, res);
+        server_->Route("POST", "/messages", [this](const Exchange& exchange) {
+            HandlePostMessage(exchange);
         });
 
-        server_->Get("/sse", [this](const httplib::Request& req, httplib::Response& res) {
-            HandleSSEConnection(req, res);
+        server_->Route("GET", "/sse", [this](const Exchange& exchange) {
+            HandleSSEConnection(exchange);
         });
+
+        // Periodically send keep-alive to detect broken connection
+        server_->StreamKeepAlive(": ping\n\n", std::chrono::seconds(15));
     }
 
-    void SSE::HandleSSEConnection(const httplib::Request& req, httplib::Response& res) {
+    void SSE::HandleSSEConnection(const Exchange& exchange) {
+        const HttpRequest& req = exchange->Request();
         LOG(DEBUG) << "SSE client connected" << std::endl;
         LOG(DEBUG) << "Request headers:" << std::endl;
         for (const auto &header: req.headers) {
@@ -174,144 +193,152 @@ namespace vx::transport {
         LOG(DEBUG) << "Request method: " << req.method << std::endl;
         LOG(DEBUG) << "Request path: " << req.path << std::endl;
         LOG(DEBUG) << "Request version: " << req.version << std::endl;
-        LOG(DEBUG) << "Request remote address: " << req.remote_addr << std::endl;
-        LOG(DEBUG) << "Request remote port: " << req.remote_port << std::endl;
-
-        SetCORSHeaders(res);
-        res.set_header("Content-Type", "text/event-stream");
-        res.set_header("Cache-Control", "no-cache");
-        res.set_header("Connection", "keep-alive");
-
-        client_connected_.store(true);
-        sse_active_.store(true);
-
-        res.set_content_provider(
-            "text/event-stream",
-            [this](size_t offset, httplib::DataSink& sink) -> bool {
-                using clock = std::chrono::steady_clock;
-                static thread_local bool first_call = true;
-                static thread_local auto last_ping = clock::now();
-                const auto ping_interval = std::chrono::seconds(15);
-
-                auto terminate = [this]() -> bool {
-                    sse_active_.store(false);
-                    client_connected_.store(false);
-                    outgoing_cv_.notify_all();
-                    incoming_cv_.notify_all();
-                    return false; // stop content provider
-                };
-
-                try {
-                    if (first_call) {
-                        first_call = false;
-
-                        std::string sessionId = vx::utils::SessionBuilder::GenerateUniqueSessionID();
-                        std::string event_endpoint = "event: endpoint\ndata: /messages?session_id=" + sessionId + "\n\n";
-                        if (!sink.write(event_endpoint.data(), event_endpoint.size())) {
-                            LOG(ERROR) << "Failed to write event_endpoint message" << std::endl;
-                            return terminate();
-                        }
-                        last_ping = clock::now();
-                    }
-
-                    // Periodically send keep-alive to detect broken connection
-                    if (clock::now() - last_ping >= ping_interval) {
-                        // SSE comment line as keep-alive
-                        const char* ping = ": ping\n\n";
-                        // If write fails, client disconnected (e.g., Ctrl+C)
-                        if (!sink.write(ping, std::strlen(ping))) {
-                            LOG(ERROR) << "Keep-alive write failed; client likely disconnected" << std::endl;
-                            return terminate();
-                        }
-                        last_ping = clock::now();
-                    }
-
-                    // If there’s no message soon, re-check writability again
-                    std::unique_lock<std::mutex> lock(outgoing_mutex_);
-                    outgoing_cv_.wait_for(lock, std::chrono::milliseconds(200), [this]() {
-                        return !outgoing_messages_.empty() || !sse_active_.load();
-                    });
-
-                    if (!sse_active_.load()) {
-                        LOG(ERROR) << "SSE connection terminating (inactive)" << std::endl;
-                        return terminate();
-                    }
-
-                    // Before sending, verify connection looks writable
-                    // If the client Ctrl+C'd, this check or the subsequent write will fail.
-                    // Note: is_writable() exists on cpp-httplib DataSink; if missing on your version,
-                    // the failed write below will handle it.
-#ifdef CPPHTTPLIB_HAS_SINK_IS_WRITABLE
-                    if (!sink.is_writable()) {
-                        LOG(DEBUG) << "Sink no longer writable; client likely disconnected" << std::endl;
-                        return terminate();
-                    }
-#endif
-
-                    if (!outgoing_messages_.empty()) {
-                        std::string message = outgoing_messages_.front();
-                        outgoing_messages_.pop();
-                        lock.unlock();
-
-                        std::string sse_msg = "data: " + message + "\n\n";
-                        LOG(DEBUG) << "Sending SSE message: " << message << std::endl;
-
-                        if (!sink.write(sse_msg.data(), sse_msg.size())) {
-                            LOG(ERROR) << "Failed to write SSE message; client disconnected" << std::endl;
-                            return terminate();
-                        }
-                    }
-
-                    return true; // continue streaming
-                } catch (const std::exception& ex) {
-                    LOG(ERROR) << "Exception in SSE content provider: " << ex.what() << std::endl;
-                    return terminate();
-                } catch (...) {
-                    LOG(ERROR) << "Unknown exception in SSE content provider" << std::endl;
-                    return terminate();
+
+        EvictIdleSessions();
+
+        // a client reconnecting to its session (/sse?session_id=...) resumes it, anybody else gets a new one
+        SessionPtr session;
+        auto sessionId = req.Query("session_id");
+        if (!sessionId.empty()) {
+            session = sessions_.Find(sessionId);
+            if (!session) {
+                LOG(ERROR) << "Unknown SSE session: " << sessionId << std::endl;
+                auto headers = CORSHeaders();
+                headers.emplace_back("Content-Type", "application/json");
+                exchange->Respond(404, std::move(headers), "{\"error\":\"Unknown session\"}");
+                return;
+            }
+        } else {
+            session = sessions_.Create();
+            LOG(INFO) << "SSE session created: " << session->id << " (" << sessions_.Size() << " active)" << std::endl;
+        }
+        Touch(*session);
+
+        auto headers = CORSHeaders();
+        headers.emplace_back("Content-Type", "text/event-stream");
+        headers.emplace_back("Cache-Control", "no-cache");
+
+        auto lastEventId = req.Header("Last-Event-ID");
+
+        // Start the stream and catch up on what the client missed under the session lock, so no
+        // new event can overtake the replayed ones. No OnClose is registered yet: nothing called
+        // inline from here can come back for the lock.
+        Exchange previous;
+        {
+            std::lock_guard<std::mutex> lock(session->mutex);
+            exchange->StartStream(200, std::move(headers));
+            std::string events = "event: endpoint\ndata: /messages?session_id=" + session->id + "\n\n";
+            if (!lastEventId.empty() && session->replay) {
+                LOG(DEBUG) << "SSE client resuming after event " << lastEventId << std::endl;
+                if (!session->replay->Replay(utils::ReplayRing::ParseId(lastEventId), events)) {
+                    LOG(WARNING) << "Some events after " << lastEventId << " are gone, replaying what is left" << std::endl;
                 }
             }
-        );
+            exchange->Send(std::move(events));
+            previous = std::exchange(session->stream, exchange);
+        }
+
+        std::weak_ptr<Session> weakSession = session;
+        std::weak_ptr<HttpExchange> weak = exchange;
+        auto disconnected = [weakSession, weak]() {
+            LOG(DEBUG) << "SSE client disconnected" << std::endl;
+            auto owner = weakSession.lock();
+            if (!owner) return;
+            std::lock_guard<std::mutex> lock(owner->mutex);
+            if (owner->stream == weak.lock()) {
+                owner->stream.reset();
+            }
+            Touch(*owner);
+        };
+        exchange->OnClose(disconnected);
+        if (!exchange->IsOpen()) {
+            disconnected(); // gone before OnClose was in place
+        }
+
+        // a new connection replaces the previous one of the session; callbacks may run inline, so end it unlocked
+        if (previous) {
+            previous->End();
+        }
     }
 
-    void SSE::HandlePostMessage(const httplib::Request& req, httplib::Response& res) {
-        SetCORSHeaders(res);
+    void SSE::HandlePostMessage(const Exchange& exchange) {
+        auto headers = CORSHeaders();
+        headers.emplace_back("Content-Type", "application/json");
 
-        if (!client_connected_.load()) {
-            res.status = 503;
-            res.set_content("{\"error\":\"No SSE connection\"}", "application/json");
+        // the endpoint event told the client which session its messages belong to
+        auto sessionId = exchange->Request().Query("session_id");
+        if (sessionId.empty()) {
+            exchange->Respond(400, std::move(headers), "{\"error\":\"Missing session_id\"}");
             return;
         }
+        SessionPtr session = sessions_.Find(sessionId);
+        if (!session) {
+            exchange->Respond(404, std::move(headers), "{\"error\":\"Unknown session\"}");
+            return;
+        }
+        Touch(*session);
 
-        std::string message = req.body;
+        {
+            std::lock_guard<std::mutex> lock(session->mutex);
+            if (!session->stream) {
+                exchange->Respond(503, std::move(headers), "{\"error\":\"No SSE connection\"}");
+                return;
+            }
+        }
+
+        std::string message = exchange->TakeBody();
         if (message.empty()) {
-            res.status = 400;
-            res.set_content("{\"error\":\"Empty message\"}", "application/json");
+            exchange->Respond(400, std::move(headers), "{\"error\":\"Empty message\"}");
             return;
         }
 
-        LOG(DEBUG) << "Received message via POST: " << message << std::endl;
+        LOG(DEBUG) << "Received message via POST (session " << session->id << "): " << message << std::endl;
         {
+            vx::InboundMessage inbound(std::move(message));
+            inbound.session = session->token;
             std::lock_guard<std::mutex> lock(incoming_mutex_);
-            incoming_messages_.push(message);
+            incoming_messages_.push(std::move(inbound));
         }
         incoming_cv_.notify_one();
 
-        res.status = 200;
-        res.set_content("{\"status\":\"received\"}", "application/json");
+        exchange->Respond(200, std::move(headers), "{\"status\":\"received\"}");
+    }
+
+    void SSE::Touch(Session& session) {
+        session.last_active.store(NowSeconds(), std::memory_order_relaxed);
+    }
+
+    void SSE::EvictIdleSessions() {
+        // a sweep at most every SSE_SESSION_SWEEP_SECONDS, run by whoever gets here first
+        int64_t now = NowSeconds();
+        int64_t last = last_sweep_.load(std::memory_order_relaxed);
+        if (now - last < SSE_SESSION_SWEEP_SECONDS || !last_sweep_.compare_exchange_strong(last, now)) {
+            return;
+        }
+
+        // a disconnected client has SSE_SESSION_RETAIN_SECONDS to come back for its session
+        auto evicted = sessions_.RemoveIf([now](Session& session) {
+            std::lock_guard<std::mutex> lock(session.mutex);
+            return (!session.stream || !session.stream->IsOpen()) &&
+                   now - session.last_active.load(std::memory_order_relaxed) > SSE_SESSION_RETAIN_SECONDS;
+        });
+        for (const auto& session : evicted) {
+            LOG(INFO) << "SSE session expired: " << session->id << std::endl;
+        }
     }
 
-    void SSE::HandleOptionsRequest(const httplib::Request& req, httplib::Response& res) {
-        SetCORSHeaders(res);
-        res.status = 200;
+    void SSE::HandleOptionsRequest(const Exchange& exchange) {
+        exchange->Respond(200, CORSHeaders());
     }
 
-    void SSE::SetCORSHeaders(httplib::Response& res) {
-        res.set_header("Access-Control-Allow-Origin", "*");
-        res.set_header("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
-        res.set_header("Access-Control-Allow-Headers", "Content-Type, Authorization, x-api-key");
-        res.set_header("Access-Control-Expose-Headers", "Content-Type, Authorization, x-api-key");
-        res.set_header("Access-Control-Max-Age", "86400");
+    HttpHeaders SSE::CORSHeaders() {
+        return {
+            {"Access-Control-Allow-Origin", "*"},
+            {"Access-Control-Allow-Methods", "GET, POST, OPTIONS"},
+            {"Access-Control-Allow-Headers", "Content-Type, Authorization, x-api-key"},
+            {"Access-Control-Expose-Headers", "Content-Type, Authorization, x-api-key"},
+            {"Access-Control-Max-Age", "86400"}
+        };
     }
 
 }
@@ -35,20 +35,25 @@
 #define MCP_SERVER_SSE_TRANSPORT_HPP
 
 #include "ITransport.h"
+#include "HttpServer.h"
 #include <memory>
 #include <atomic>
 #include <queue>
 #include <mutex>
 #include <condition_variable>
-#include <thread>
-#include <httplib.h>
-#include "utils/SessionBuilder.h"
+#include <unordered_map>
+#include "utils/SessionTable.h"
+#include "utils/ReplayRing.h"
+
+#define SSE_SESSION_RETAIN_SECONDS (5 * 60)
+#define SSE_SESSION_SWEEP_SECONDS 60
 
 namespace vx::transport {
 
     class SSE : public vx::ITransport {
     public:
-        explicit SSE(int port = 8080, std::string  host = "127.0.0.1");
+        explicit SSE(int port = 8080, std::string  host = "127.0.0.1", size_t ioThreads = HTTP_IO_THREADS,
+                     size_t replayBytes = SSE_REPLAY_BYTES);
         ~SSE();
 
         // Copy const. and assignment disabled
@@ -60,14 +65,12 @@ namespace vx::transport {
         SSE& operator=(SSE&&) = delete;
 
         // Transport interface
-        std::pair<size_t, std::string> Read() override;
-        void Write(const std::string& json_data) override;
-
-        std::future<std::pair<size_t, std::string>> ReadAsync() override;
-        std::future<void> WriteAsync(const std::string& json_data) override;
+        vx::InboundMessage Read() override;
+        void Write(const vx::OutboundMessage& message) override;
+        void WriteBatch(std::vector<vx::OutboundMessage>& messages) override;
 
         std::string GetName() override { return "sse"; };
-        std::string GetVersion() override { return "0.4"; };
+        std::string GetVersion() override { return "0.7"; };
         int GetPort() override { return port_; };
 
         bool Start() override;
@@ -75,30 +78,43 @@ namespace vx::transport {
         bool IsRunning() override { return server_running_.load(); }
 
     private:
+        using Exchange = std::shared_ptr<HttpExchange>;
+
+        // One client: its SSE connection, and the numbered events kept for its reconnection
+        struct Session {
+            std::string id;
+            uint64_t token = 0;
+            std::mutex mutex;
+            Exchange stream;
+            std::unique_ptr<utils::ReplayRing> replay; // from the first event sent to the session on
+            std::atomic<int64_t> last_active {0};
+        };
+        using SessionPtr = std::shared_ptr<Session>;
+
         void SetupRoutes();
-        void HandleSSEConnection(const httplib::Request& req, httplib::Response& res);
-        void HandlePostMessage(const httplib::Request& req, httplib::Response& res);
+        void HandleSSEConnection(const Exchange& exchange);
+        void HandlePostMessage(const Exchange& exchange);
+        void SendEvents(uint64_t session, const std::vector<const std::string*>& payloads);
+        static void Touch(Session& session);
+        void EvictIdleSessions();
 
-        static void HandleOptionsRequest(const httplib::Request& req, httplib::Response& res);
-        static void SetCORSHeaders(httplib::Response& res);
+        static void HandleOptionsRequest(const Exchange& exchange);
+        static HttpHeaders CORSHeaders();
 
         std::string host_;
         int port_;
-        std::unique_ptr<httplib::Server> server_;
-        std::thread server_thread_;
+        size_t replay_bytes_;
+        std::unique_ptr<HttpServer> server_;
         std::atomic<bool> server_running_ {false};
-        std::atomic<bool> client_connected_ {false};
 
-        // Message queues for bidirectional connections
-        std::queue<std::string> incoming_messages_;
-        std::queue<std::string> outgoing_messages_;
+        // Clients, keyed by the session_id of their /messages endpoint
+        utils::SessionTable<Session> sessions_;
+        std::atomic<int64_t> last_sweep_ {0};
+
+        // Messages posted by the clients, consumed by Read()
+        std::queue<vx::InboundMessage> incoming_messages_;
         std::mutex incoming_mutex_;
-        std::mutex outgoing_mutex_;
         std::condition_variable incoming_cv_;
-        std::condition_variable outgoing_cv_;
-
-        // SSE connection management
-        std::atomic<bool> sse_active_ {false};
     };
 
 }
@@ -23,46 +23,221 @@
 //
 
 #include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+#include <algorithm>
 #include "StdioTransport.h"
 #include "aixlog.hpp"
 
+#ifdef _WIN32
+#include <io.h>
+#include <climits>
+#else
+#include <poll.h>
+#include <unistd.h>
+#endif
+
 namespace vx::transport {
 
-    std::pair<size_t, std::string> Stdio::Read() {
-        std::string line;
-        std::string json_data;
+    bool Stdio::FillBuffer() {
+        // keep the partial message at the front and make room for a full block after it
+        if (begin_ > 0) {
+            std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+            end_ -= begin_;
+            begin_ = 0;
+        }
+        if (buffer_.size() - end_ < STDIO_READ_BLOCK / 2) {
+            buffer_.resize(buffer_.size() * 2);
+        }
 
-        // Read headers until an empty line
         while (true) {
-            int c;
-            while ((c = std::getc(stdin)) != EOF && c != '\n') {
-                json_data += static_cast<char>(c);
+#ifdef _WIN32
+            int count = ::_read(0, buffer_.data() + end_, static_cast<unsigned int>(buffer_.size() - end_));
+#else
+            ssize_t count = ::read(STDIN_FILENO, buffer_.data() + end_, buffer_.size() - end_);
+#endif
+            if (count > 0) {
+                end_ += static_cast<size_t>(count);
+                return true;
+            }
+            if (count < 0 && errno == EINTR) continue;
+            if (count < 0) {
+                LOG(ERROR) << "read from stdin failed: " << std::strerror(errno) << std::endl;
+            }
+            eof_ = true;
+            return false;
+        }
+    }
+
+    vx::InboundMessage Stdio::Read() {
+        // one message per line: scan whole blocks for the newline instead of reading byte by byte
+        size_t scanned = begin_;
+        while (true) {
+            auto* newline = static_cast<const char*>(std::memchr(buffer_.data() + scanned, '\n', end_ - scanned));
+            if (newline) {
+                size_t length = newline - (buffer_.data() + begin_);
+                size_t start = begin_;
+                begin_ += length + 1;
+                if (length == 0) { // blank line, nothing to hand out
+                    scanned = begin_;
+                    continue;
+                }
+                return vx::InboundMessage(std::string(buffer_.data() + start, length));
+            }
+
+            size_t pending = end_ - begin_;
+            if (eof_ || !FillBuffer()) {
+                // end of input: whatever is left is the last message
+                std::string last(buffer_.data() + begin_, pending);
+                begin_ = end_ = 0;
+                return vx::InboundMessage(std::move(last));
             }
-            break;
+            scanned = begin_ + pending; // the bytes before were already scanned
+        }
+    }
+
+    bool Stdio::Start() {
+        std::lock_guard<std::mutex> lock(output_mutex_);
+        if (policy_ == FlushPolicy::Delayed && !flusher_running_) {
+            flusher_running_ = true;
+            flusher_thread_ = std::thread(&Stdio::FlusherLoop, this);
+        }
+        return true;
+    }
+
+    void Stdio::Stop() {
+        {
+            std::lock_guard<std::mutex> lock(output_mutex_);
+            flusher_running_ = false;
+        }
+        flush_cv_.notify_one();
+        if (flusher_thread_.joinable()) {
+            flusher_thread_.join();
+        }
+        std::lock_guard<std::mutex> lock(output_mutex_);
+        FlushLocked();
+    }
+
+    void Stdio::Write(const vx::OutboundMessage& message) {
+        std::vector<vx::OutboundMessage> single {message};
+        WriteBatch(single);
+    }
+
+    void Stdio::WriteBatch(std::vector<vx::OutboundMessage>& messages) {
+        if (messages.empty()) return;
+
+        std::lock_guard<std::mutex> lock(output_mutex_);
+        bool wasEmpty = output_.empty();
+        for (const auto& message : messages) {
+            output_.append(message.payload);
+            output_.push_back('\n');
+        }
+        if (streaming_ && output_.size() > STDIO_STREAM_BACKLOG && !stream_overrun_.exchange(true)) {
+            LOG(WARNING) << "Output held up behind a streamed response, cutting the stream short" << std::endl;
         }
 
-        return {json_data.length(), json_data};
+        if (policy_ == FlushPolicy::Immediate || !flusher_running_ || output_.size() >= STDIO_FLUSH_THRESHOLD) {
+            FlushLocked();
+        } else if (wasEmpty) {
+            // the flusher writes it out once the oldest byte has waited maxDelay_
+            oldestOutput_ = std::chrono::steady_clock::now();
+            flush_cv_.notify_one();
+        }
     }
 
-    std::future<std::pair<size_t, std::string>> Stdio::ReadAsync() {
-        return std::async(std::launch::async, []() {
-            std::string json_data;
-            int c;
-            while ((c = std::getc(stdin)) != EOF && c != '\n') {
-                json_data += static_cast<char>(c);
+    // Written straight to fd 1 piece by piece; the newline ending the message hands fd 1 back
+    class Stdio::Stream : public vx::OutboundStream {
+    public:
+        explicit Stream(Stdio& owner) : owner_(owner) {}
+        ~Stream() override { Close(); }
+
+        bool Write(std::string_view data) override {
+            if (closed_ || owner_.stream_overrun_.load()) return false;
+            return owner_.WriteAll(data.data(), data.size());
+        }
+
+        void Close() override {
+            if (std::exchange(closed_, true)) return;
+            owner_.WriteAll("\n", 1);
+            {
+                std::lock_guard<std::mutex> lock(owner_.output_mutex_);
+                owner_.streaming_ = false;
+                owner_.FlushLocked(); // what was written meanwhile
             }
-            return std::make_pair(json_data.length(), json_data);
-        });
+            owner_.stream_cv_.notify_one();
+        }
+
+        // fd 1 is the only channel to the client: the line ends where the message broke off,
+        // so it does not parse and the next message starts on a line of its own
+        void Abort() override {
+            Close();
+        }
+
+    private:
+        Stdio& owner_;
+        bool closed_ = false;
+    };
+
+    std::unique_ptr<vx::OutboundStream> Stdio::OpenStream(uint64_t, const vx::MessageId&) {
+        std::unique_lock<std::mutex> lock(output_mutex_);
+        stream_cv_.wait(lock, [this]() { return !streaming_; });
+        FlushLocked();
+        streaming_ = true;
+        stream_overrun_ = false;
+        return std::make_unique<Stream>(*this);
     }
 
-    void Stdio::Write(const std::string& json_data) {
-        std::cout << json_data << std::endl << std::flush;
+    void Stdio::FlushLocked() {
+        if (output_.empty() || streaming_) return;
+        WriteAll(output_.data(), output_.size());
+        output_.clear();
+    }
+
+    void Stdio::FlusherLoop() {
+        std::unique_lock<std::mutex> lock(output_mutex_);
+        while (flusher_running_) {
+            if (output_.empty() || streaming_) {
+                flush_cv_.wait(lock);
+                continue;
+            }
+            auto deadline = oldestOutput_ + maxDelay_;
+            if (std::chrono::steady_clock::now() >= deadline) {
+                FlushLocked();
+            } else {
+                flush_cv_.wait_until(lock, deadline);
+            }
+        }
     }
 
-    std::future<void> Stdio::WriteAsync(const std::string& json_data) {
-        return std::async(std::launch::async, [json_data]() {
-            std::cout << json_data << std::endl << std::flush;
-        });
+    bool Stdio::WriteAll(const char* data, size_t size) {
+        if (stdout_broken_.load()) return false;
+
+        // fd 1 directly: no iostream formatting and no flush per message
+        while (size > 0) {
+#ifdef _WIN32
+            int written = ::_write(1, data, static_cast<unsigned int>(std::min<size_t>(size, INT_MAX)));
+#else
+            ssize_t written = ::write(STDOUT_FILENO, data, size);
+#endif
+            if (written < 0) {
+                if (errno == EINTR) continue;
+#ifndef _WIN32
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    // stdout was left non-blocking by our parent: wait until the pipe drains
+                    pollfd pfd {STDOUT_FILENO, POLLOUT, 0};
+                    ::poll(&pfd, 1, -1);
+                    continue;
+                }
+#endif
+                LOG(ERROR) << "write to stdout failed: " << std::strerror(errno) << std::endl;
+                stdout_broken_ = true;
+                return false;
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+        return true;
     }
 
 }
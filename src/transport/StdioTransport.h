@@ -25,27 +25,77 @@
 #ifndef MCP_SERVER_STDIO_TRANSPORT_H
 #define MCP_SERVER_STDIO_TRANSPORT_H
 
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
 #include "ITransport.h"
 
+#define STDIO_READ_BLOCK (64 * 1024)
+#define STDIO_FLUSH_THRESHOLD (64 * 1024)
+#define STDIO_STREAM_BACKLOG (1024 * 1024)
+
 namespace vx::transport {
 
     class Stdio : public vx::ITransport {
     public:
-        Stdio() = default;
+        enum class FlushPolicy {
+            Immediate,  // every Write/WriteBatch ends with a write to fd 1
+            Delayed     // output is held up to maxDelay (or STDIO_FLUSH_THRESHOLD bytes) to merge writes
+        };
 
-        std::pair<size_t, std::string> Read() override;
-        void Write(const std::string& json_data) override;
+        explicit Stdio(FlushPolicy policy = FlushPolicy::Immediate,
+                       std::chrono::microseconds maxDelay = std::chrono::microseconds(0))
+            : policy_(policy), maxDelay_(maxDelay) {}
+        ~Stdio() override { Stop(); }
 
-        std::future<std::pair<size_t, std::string>> ReadAsync() override;
-        std::future<void> WriteAsync(const std::string& json_data) override;
+        vx::InboundMessage Read() override;
+        void Write(const vx::OutboundMessage& message) override;
+        void WriteBatch(std::vector<vx::OutboundMessage>& messages) override;
+        std::unique_ptr<vx::OutboundStream> OpenStream(uint64_t session, const vx::MessageId& id) override;
 
         std::string GetName() override { return "stdio"; }
         std::string GetVersion() override { return "0.2"; }
         int GetPort() override { return 0; }
 
-        bool Start() override { return true; }
-        void Stop() override {}
+        bool Start() override;
+        void Stop() override;
         bool IsRunning() override { return true; }
+
+    private:
+        class Stream;
+
+        bool FillBuffer();
+        void FlushLocked();
+        void FlusherLoop();
+        bool WriteAll(const char* data, size_t size);
+
+        // bytes read from stdin and not consumed yet live in [begin_, end_)
+        std::vector<char> buffer_ = std::vector<char>(STDIO_READ_BLOCK);
+        size_t begin_ = 0;
+        size_t end_ = 0;
+        bool eof_ = false;
+
+        // output not written yet; cleared after each flush so its capacity is reused
+        FlushPolicy policy_;
+        std::chrono::microseconds maxDelay_;
+        std::string output_;
+        std::chrono::steady_clock::time_point oldestOutput_;
+        std::mutex output_mutex_;
+        std::condition_variable flush_cv_;
+        std::thread flusher_thread_;
+        bool flusher_running_ = false;
+
+        // a streamed message owns fd 1 until its last piece: other output waits in output_, up to
+        // STDIO_STREAM_BACKLOG bytes; past that the stream is cut short to hand fd 1 back
+        bool streaming_ = false;
+        std::atomic<bool> stream_overrun_ {false};
+        std::condition_variable stream_cv_;
+
+        // a failed write to fd 1 means nobody reads it anymore: later output is dropped
+        std::atomic<bool> stdout_broken_ {false};
     };
 
 }
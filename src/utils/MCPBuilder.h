@@ -25,6 +25,8 @@
 #ifndef MCP_SERVER_MCPBUILDER_H
 #define MCP_SERVER_MCPBUILDER_H
 
+#include <string>
+#include <string_view>
 #include "json.hpp"
 #include "base64.hpp"
 
@@ -50,6 +52,29 @@ public:
         return response;
     }
 
+    /// Serialized response around an already serialized result; only the id is dumped per call.
+    static std::string RawResponse(const json& id, std::string_view result) {
+        std::string response;
+        std::string id_str = id.dump();
+        response.reserve(result.size() + id_str.size() + 40);
+        response.append(R"({"jsonrpc":"2.0","id":)").append(id_str).append(R"(,"result":)").append(result).append("}");
+        return response;
+    }
+
+    /// Same as RawResponse, adding `member` ("key":value) in front of the members of the result
+    /// object; `result` must be a serialized object.
+    static std::string RawResponse(const json& id, std::string_view result, std::string_view member, bool emptyResult) {
+        size_t brace = result.find('{') + 1;
+        std::string response;
+        std::string id_str = id.dump();
+        response.reserve(result.size() + member.size() + id_str.size() + 41);
+        response.append(R"({"jsonrpc":"2.0","id":)").append(id_str).append(R"(,"result":)")
+                .append(result.substr(0, brace)).append(member);
+        if (!emptyResult) response.push_back(',');
+        response.append(result.substr(brace)).append("}");
+        return response;
+    }
+
     static json Error(ErrorCode code, const std::string& id, const std::string &message) {
         return {
                 {"jsonrpc", "2.0"},
@@ -58,6 +83,14 @@ public:
         };
     }
 
+    static json Error(ErrorCode code, const json& id, const std::string &message) {
+        return {
+                {"jsonrpc", "2.0"},
+                {"error", {{"code", code}, {"message", message}}},
+                {"id", id}
+        };
+    }
+
     static json TextContent(const std::string& text) {
         return json::object({
             {"type","text"},
@@ -0,0 +1,184 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef MCP_SERVER_MPSC_QUEUE_H
+#define MCP_SERVER_MPSC_QUEUE_H
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+namespace vx::utils {
+
+    /// Bounded lock-free multi-producer / single-consumer ring buffer.
+    /// Each cell carries a sequence number (D. Vyukov's bounded queue) so producers
+    /// only contend on a single fetch/CAS of the enqueue position and never on a mutex.
+    /// The consumer sleeps on an atomic counter (C++20 wait/notify) when the ring is empty,
+    /// producers sleep on another one when it is full; either side only pays for a notify
+    /// when the other one has announced that it is about to sleep.
+    template<typename T>
+    class MPSCQueue {
+    public:
+        explicit MPSCQueue(size_t capacity) {
+            size_t size = 2;
+            while (size < capacity) size <<= 1;
+            mask_ = size - 1;
+            cells_ = std::make_unique<Cell[]>(size);
+            for (size_t i = 0; i < size; i++) {
+                cells_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        MPSCQueue(const MPSCQueue&) = delete;
+        MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+        /// Non-blocking enqueue; returns false if the ring is full or closed.
+        bool TryPush(T&& value) {
+            // announce the push before looking at closed_, Close() waits for it to be published
+            producers_.fetch_add(1);
+            if (closed_.load()) {
+                LeaveProducer();
+                return false;
+            }
+
+            size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+            Cell* cell;
+            while (true) {
+                cell = &cells_[pos & mask_];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+                if (diff == 0) {
+                    if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                } else if (diff < 0) {
+                    LeaveProducer();
+                    return false; // full
+                } else {
+                    pos = enqueue_pos_.load(std::memory_order_relaxed);
+                }
+            }
+
+            cell->data = std::move(value);
+            cell->sequence.store(pos + 1, std::memory_order_release);
+
+            pushed_.fetch_add(1);
+            if (consumer_waiting_.load()) pushed_.notify_one();
+            LeaveProducer();
+            return true;
+        }
+
+        /// Enqueue, sleeping while the ring is full; returns false only once closed.
+        bool Push(T&& value) {
+            while (true) {
+                uint32_t observed = popped_.load();
+                if (TryPush(std::move(value))) return true;
+                if (closed_.load()) return false;
+
+                // a pop after `observed` changes popped_, so the wait cannot miss it
+                producers_waiting_.fetch_add(1);
+                popped_.wait(observed);
+                producers_waiting_.fetch_sub(1);
+            }
+        }
+
+        /// Non-blocking dequeue. Must only be called from the consumer thread.
+        bool TryPop(T& value) {
+            Cell* cell = &cells_[dequeue_pos_ & mask_];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(dequeue_pos_ + 1) < 0) {
+                return false; // empty
+            }
+
+            value = std::move(cell->data);
+            cell->sequence.store(dequeue_pos_ + mask_ + 1, std::memory_order_release);
+            dequeue_pos_++;
+
+            popped_.fetch_add(1);
+            if (producers_waiting_.load() > 0) popped_.notify_all();
+            return true;
+        }
+
+        /// Blocking dequeue; returns false when the queue is closed and fully drained.
+        bool WaitPop(T& value) {
+            while (true) {
+                uint32_t observed = pushed_.load();
+                if (TryPop(value)) return true;
+                // sealed_ is only set once every producer that got past closed_ has published
+                if (sealed_.load()) return TryPop(value);
+
+                consumer_waiting_.store(true);
+                pushed_.wait(observed);
+                consumer_waiting_.store(false);
+            }
+        }
+
+        /// Reject new messages, wait for the pushes already in flight and wake up everybody.
+        void Close() {
+            closed_.store(true);
+            for (uint32_t inFlight = producers_.load(); inFlight != 0; inFlight = producers_.load()) {
+                producers_.wait(inFlight);
+            }
+            sealed_.store(true);
+
+            pushed_.fetch_add(1);
+            pushed_.notify_all();
+            popped_.fetch_add(1);
+            popped_.notify_all();
+        }
+
+        void Reopen() {
+            sealed_.store(false);
+            closed_.store(false);
+        }
+
+        inline size_t Capacity() const { return mask_ + 1; }
+
+    private:
+        struct Cell {
+            std::atomic<size_t> sequence;
+            T data;
+        };
+
+        void LeaveProducer() {
+            if (producers_.fetch_sub(1) == 1 && closed_.load()) producers_.notify_all();
+        }
+
+        std::unique_ptr<Cell[]> cells_;
+        size_t mask_ = 0;
+
+        // the wake-up handshakes (announce, then re-check) rely on the default seq_cst ordering
+        alignas(64) std::atomic<size_t> enqueue_pos_ {0};
+        alignas(64) size_t dequeue_pos_ = 0;
+        alignas(64) std::atomic<uint32_t> pushed_ {0};
+        std::atomic<bool> consumer_waiting_ {false};
+        alignas(64) std::atomic<uint32_t> popped_ {0};
+        std::atomic<uint32_t> producers_waiting_ {0};
+        alignas(64) std::atomic<uint32_t> producers_ {0};
+        std::atomic<bool> closed_ {false};
+        std::atomic<bool> sealed_ {false};
+    };
+
+}
+
+#endif //MCP_SERVER_MPSC_QUEUE_H
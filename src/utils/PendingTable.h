@@ -0,0 +1,67 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+#ifndef MCP_SERVER_PENDING_TABLE_H
+#define MCP_SERVER_PENDING_TABLE_H
+
+#include <memory>
+#include <cstdint>
+#include <functional>
+#include "Message.h"
+#include "StripedMap.h"
+
+namespace vx::utils {
+
+    /// A request waiting for its response: two clients may well use the same JSON-RPC id
+    struct PendingKey {
+        uint64_t session;
+        vx::MessageId id;
+
+        bool operator==(const PendingKey& other) const { return session == other.session && id == other.id; }
+    };
+
+    struct PendingKeyHash {
+        size_t operator()(const PendingKey& key) const {
+            return vx::MessageIdHash()(key.id) ^ (std::hash<uint64_t>()(key.session) * 0x9E3779B97F4A7C15ull);
+        }
+    };
+
+    /// What the transport answers the request on, and the session it belongs to
+    template<typename Exchange, typename Session>
+    struct PendingRequest {
+        std::shared_ptr<Exchange> exchange;
+        std::shared_ptr<Session> session;
+        bool accepts_stream = false; // the client takes a text/event-stream answer
+        bool streaming = false;      // ... and got one: the response is the stream's last event
+    };
+
+    /// Requests waiting for their response, keyed by (session, id): nothing blocks, the
+    /// transport answers the exchange when the response is written
+    template<typename Exchange, typename Session>
+    using PendingTable = StripedMap<PendingKey, PendingRequest<Exchange, Session>, PendingKeyHash>;
+
+}
+
+#endif //MCP_SERVER_PENDING_TABLE_H
@@ -0,0 +1,124 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef MCP_SERVER_REPLAY_RING_H
+#define MCP_SERVER_REPLAY_RING_H
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <cstdint>
+#include <utility>
+#include <memory>
+
+#define SSE_REPLAY_BYTES (1024 * 1024)
+
+namespace vx::utils {
+
+    /// Numbers the events of a server-sent event stream and keeps the most recent ones,
+    /// up to `capacity` bytes of payload, so a client reconnecting with Last-Event-ID gets
+    /// what it missed. Payloads are shared, not copied: an event broadcast to every session
+    /// is kept once whatever the number of sessions, and framed only for the streams it is
+    /// sent to or replayed on. Not thread-safe: the owner of the stream serializes the calls.
+    class ReplayRing {
+    public:
+        using Payload = std::shared_ptr<const std::string>;
+
+        explicit ReplayRing(size_t capacity = SSE_REPLAY_BYTES) : capacity_(capacity) {}
+
+        /// Remember `data` as the next event (of type `event`, if not empty) and, when `out`
+        /// is not null, append it framed to `out`; returns the id of the event
+        uint64_t Append(std::string* out, std::string_view event, Payload data) {
+            uint64_t id = nextId_++;
+            if (out) Frame(*out, id, event, *data);
+            if (capacity_ == 0) return id;
+
+            bytes_ += data->size();
+            events_.push_back({id, std::string(event), std::move(data)});
+            while (bytes_ > capacity_ && !events_.empty()) {
+                bytes_ -= events_.front().data->size();
+                events_.pop_front();
+            }
+            return id;
+        }
+
+        /// Append to `out` the events that came after `lastId`; false if some of them
+        /// are not available anymore (what is left is appended anyway)
+        bool Replay(uint64_t lastId, std::string& out) const {
+            uint64_t first = events_.empty() ? nextId_ : events_.front().id;
+            for (size_t i = lastId >= first ? lastId + 1 - first : 0; i < events_.size(); i++) {
+                Frame(out, events_[i].id, events_[i].event, *events_[i].data);
+            }
+            return lastId + 1 >= first;
+        }
+
+        /// Parse a Last-Event-ID header value; 0 when it is missing or not one of our ids
+        static uint64_t ParseId(std::string_view value) {
+            uint64_t id = 0;
+            auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), id);
+            return ec == std::errc() && end == value.data() + value.size() ? id : 0;
+        }
+
+        uint64_t LastId() const { return nextId_ - 1; }
+
+        /// Append `data` to the data field of an event being framed: each line break in it
+        /// (CR, LF or CRLF) starts another `data: ` line, so the client joins the lines back
+        /// into what was sent instead of taking the rest of a line for a field of its own
+        static void AppendData(std::string& out, std::string_view data) {
+            size_t start = 0;
+            for (size_t end; (end = data.find_first_of("\r\n", start)) != std::string_view::npos; ) {
+                out.append(data.substr(start, end - start)).append("\ndata: ");
+                start = end + (data[end] == '\r' && end + 1 < data.size() && data[end + 1] == '\n' ? 2 : 1);
+            }
+            out.append(data.substr(start));
+        }
+
+    private:
+        struct Event {
+            uint64_t id;
+            std::string event;
+            Payload data;
+        };
+
+        static void Frame(std::string& out, uint64_t id, std::string_view event, std::string_view data) {
+            char digits[20];
+            auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), id);
+            out.reserve(out.size() + 16 + event.size() + data.size() + 20);
+            out.append("id: ").append(digits, end).push_back('\n');
+            if (!event.empty()) out.append("event: ").append(event).push_back('\n');
+            out.append("data: ");
+            AppendData(out, data);
+            out.append("\n\n");
+        }
+
+        std::deque<Event> events_; // consecutive ids, oldest first
+        size_t bytes_ = 0;
+        size_t capacity_;
+        uint64_t nextId_ = 1;
+    };
+
+}
+
+#endif //MCP_SERVER_REPLAY_RING_H
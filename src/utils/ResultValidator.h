@@ -0,0 +1,90 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef MCP_SERVER_RESULT_VALIDATOR_H
+#define MCP_SERVER_RESULT_VALIDATOR_H
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include "json.hpp"
+
+namespace vx::utils {
+
+    /// SAX pass over a serialized plugin result: checks it is well-formed JSON
+    /// and reports the shape of its top level without building a DOM, so the
+    /// bytes can be spliced into a response as they are.
+    class ResultValidator {
+    public:
+        using json = nlohmann::json;
+
+        struct Shape {
+            bool valid = false;         // well-formed JSON
+            bool object = false;        // top level is an object
+            bool empty = true;          // top level object has no members
+            bool hasIsError = false;    // top level object has an "isError" member
+            bool multiline = false;     // has raw line breaks (whitespace between tokens)
+        };
+
+        static Shape Scan(std::string_view text) {
+            ResultValidator validator;
+            validator.shape_.valid = json::sax_parse(text.begin(), text.end(), &validator,
+                                                     json::input_format_t::json, true, false);
+            if (!validator.shape_.valid) validator.shape_ = Shape();
+            else validator.shape_.multiline = text.find_first_of("\r\n") != std::string_view::npos;
+            return validator.shape_;
+        }
+
+        // SAX interface
+        bool null() { return true; }
+        bool boolean(bool) { return true; }
+        bool number_integer(json::number_integer_t) { return true; }
+        bool number_unsigned(json::number_unsigned_t) { return true; }
+        bool number_float(json::number_float_t, const json::string_t&) { return true; }
+        bool string(json::string_t&) { return true; }
+        bool binary(json::binary_t&) { return true; }
+        bool start_object(std::size_t) {
+            if (depth_++ == 0) shape_.object = true;
+            return true;
+        }
+        bool key(json::string_t& key) {
+            if (depth_ == 1) {
+                shape_.empty = false;
+                if (key == "isError") shape_.hasIsError = true;
+            }
+            return true;
+        }
+        bool end_object() { depth_--; return true; }
+        bool start_array(std::size_t) { depth_++; return true; }
+        bool end_array() { depth_--; return true; }
+        bool parse_error(std::size_t, const std::string&, const json::exception&) { return false; }
+
+    private:
+        std::size_t depth_ = 0;
+        Shape shape_;
+    };
+
+}
+
+#endif //MCP_SERVER_RESULT_VALIDATOR_H
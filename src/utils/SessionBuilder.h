@@ -26,6 +26,8 @@
 #define MCP_SERVER_SESSION_BUILDER_H
 
 #include <chrono>
+#include <string>
+#include <cstdint>
 #include <random>
 #include <sstream>
 #include <iomanip>
@@ -39,9 +41,9 @@ namespace vx::utils {
             auto timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
                 now.time_since_epoch()).count();
 
-            static std::random_device rd;
-            static std::mt19937 gen(rd());
-            static std::uniform_int_distribution<uint32_t> dis;
+            // sessions are created concurrently by the I/O threads: one generator each
+            thread_local std::mt19937 gen(std::random_device{}());
+            std::uniform_int_distribution<uint32_t> dis;
 
             std::stringstream ss;
             ss << std::hex << timestamp << "-" << dis(gen);
@@ -0,0 +1,148 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef MCP_SERVER_SESSION_TABLE_H
+#define MCP_SERVER_SESSION_TABLE_H
+
+#include <array>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include "SessionBuilder.h"
+
+#define SESSION_TABLE_SHARDS 16
+
+namespace vx::utils {
+
+    /// Sessions of a transport, lock-striped over SESSION_TABLE_SHARDS shards so that
+    /// lookups of different sessions do not contend. Session is any type with
+    /// `std::string id` and `uint64_t token` members: the token is the numeric handle
+    /// carried along with messages, the id is what clients see, e.g. in Mcp-Session-Id.
+    template<typename Session>
+    class SessionTable {
+    public:
+        std::shared_ptr<Session> Create() {
+            auto session = std::make_shared<Session>();
+            session->token = nextToken_.fetch_add(1, std::memory_order_relaxed);
+            // the token is spelled out at the end of the id, so the id finds its shard directly
+            char token[17];
+            auto [end, ec] = std::to_chars(token, token + sizeof(token), session->token, 16);
+            session->id = SessionBuilder::GenerateUniqueSessionID() + "-" + std::string(token, end);
+
+            auto& shard = ShardOf(session->token);
+            std::unique_lock lock(shard.mutex);
+            shard.sessions.emplace(session->token, session);
+            size_.fetch_add(1, std::memory_order_relaxed);
+            return session;
+        }
+
+        std::shared_ptr<Session> Find(uint64_t token) const {
+            const auto& shard = ShardOf(token);
+            std::shared_lock lock(shard.mutex);
+            auto it = shard.sessions.find(token);
+            return it != shard.sessions.end() ? it->second : nullptr;
+        }
+
+        std::shared_ptr<Session> Find(std::string_view id) const {
+            uint64_t token = TokenOf(id);
+            if (token == 0) return nullptr;
+            auto session = Find(token);
+            return session && session->id == id ? session : nullptr;
+        }
+
+        bool Remove(uint64_t token) {
+            auto& shard = ShardOf(token);
+            std::unique_lock lock(shard.mutex);
+            if (shard.sessions.erase(token) == 0) return false;
+            size_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        /// Call `visit` on every session; shards are copied first so `visit` may use the table
+        template<typename Visitor>
+        void ForEach(Visitor&& visit) const {
+            for (const auto& shard : shards_) {
+                std::vector<std::shared_ptr<Session>> sessions;
+                {
+                    std::shared_lock lock(shard.mutex);
+                    sessions.reserve(shard.sessions.size());
+                    for (const auto& [token, session] : shard.sessions) sessions.push_back(session);
+                }
+                for (const auto& session : sessions) visit(session);
+            }
+        }
+
+        /// Remove and return the sessions matching `expired`
+        template<typename Predicate>
+        std::vector<std::shared_ptr<Session>> RemoveIf(Predicate&& expired) {
+            std::vector<std::shared_ptr<Session>> removed;
+            for (auto& shard : shards_) {
+                std::unique_lock lock(shard.mutex);
+                for (auto it = shard.sessions.begin(); it != shard.sessions.end();) {
+                    if (expired(*it->second)) {
+                        removed.push_back(std::move(it->second));
+                        it = shard.sessions.erase(it);
+                        size_.fetch_sub(1, std::memory_order_relaxed);
+                    } else {
+                        ++it;
+                    }
+                }
+            }
+            return removed;
+        }
+
+        size_t Size() const { return size_.load(std::memory_order_relaxed); }
+
+    private:
+        struct Shard {
+            mutable std::shared_mutex mutex;
+            std::unordered_map<uint64_t, std::shared_ptr<Session>> sessions;
+        };
+
+        static uint64_t TokenOf(std::string_view id) {
+            size_t dash = id.rfind('-');
+            if (dash == std::string_view::npos) return 0;
+            uint64_t token = 0;
+            auto [end, ec] = std::from_chars(id.data() + dash + 1, id.data() + id.size(), token, 16);
+            return ec == std::errc() && end == id.data() + id.size() ? token : 0;
+        }
+
+        Shard& ShardOf(uint64_t token) { return shards_[token % SESSION_TABLE_SHARDS]; }
+        const Shard& ShardOf(uint64_t token) const { return shards_[token % SESSION_TABLE_SHARDS]; }
+
+        std::array<Shard, SESSION_TABLE_SHARDS> shards_;
+        std::atomic<uint64_t> nextToken_ {1}; // 0 means "no session"
+        std::atomic<size_t> size_ {0};
+    };
+
+}
+
+#endif //MCP_SERVER_SESSION_TABLE_H
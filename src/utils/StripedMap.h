@@ -0,0 +1,141 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef MCP_SERVER_STRIPED_MAP_H
+#define MCP_SERVER_STRIPED_MAP_H
+
+#include <array>
+#include <vector>
+#include <mutex>
+#include <utility>
+#include <optional>
+#include <cstdint>
+#include <unordered_map>
+
+#define STRIPED_MAP_STRIPES 64
+#define STRIPED_MAP_SPARE_NODES 64
+
+namespace vx::utils {
+
+    /// Hash map split over STRIPED_MAP_STRIPES independently locked stripes:
+    /// operations on keys of different stripes never wait for each other.
+    /// Meant for short-lived entries that are inserted once and taken once,
+    /// e.g. requests waiting for their response: the map nodes of taken entries
+    /// are kept (up to STRIPED_MAP_SPARE_NODES per stripe) and reused by the next
+    /// inserts, so a steady flow of entries does not allocate.
+    template<typename Key, typename Value, typename Hash = std::hash<Key>>
+    class StripedMap {
+    public:
+        /// Add an entry for `key`; false (and nothing changes) if there is one already
+        bool Insert(const Key& key, Value value) {
+            auto& stripe = StripeOf(key);
+            std::lock_guard<std::mutex> lock(stripe.mutex);
+            if (stripe.spare.empty()) {
+                return stripe.entries.try_emplace(key, std::move(value)).second;
+            }
+
+            auto node = std::move(stripe.spare.back());
+            stripe.spare.pop_back();
+            node.key() = key;
+            node.mapped() = std::move(value);
+            auto result = stripe.entries.insert(std::move(node));
+            if (!result.inserted) Recycle(stripe, std::move(result.node));
+            return result.inserted;
+        }
+
+        /// Remove the entry of `key` and hand it to the caller
+        std::optional<Value> Take(const Key& key) {
+            return TakeIf(key, [](const Value&) { return true; });
+        }
+
+        /// Remove the entry of `key` only if `match(value)` holds
+        template<typename Predicate>
+        std::optional<Value> TakeIf(const Key& key, Predicate&& match) {
+            auto& stripe = StripeOf(key);
+            std::lock_guard<std::mutex> lock(stripe.mutex);
+            auto it = stripe.entries.find(key);
+            if (it == stripe.entries.end() || !match(it->second)) return std::nullopt;
+            auto node = stripe.entries.extract(it);
+            std::optional<Value> value(std::move(node.mapped()));
+            Recycle(stripe, std::move(node));
+            return value;
+        }
+
+        /// Run `visit(value)` on the entry of `key` under its stripe lock; false if there is none.
+        /// `visit` must be short and must not call back into the map.
+        template<typename Visitor>
+        bool Visit(const Key& key, Visitor&& visit) {
+            auto& stripe = StripeOf(key);
+            std::lock_guard<std::mutex> lock(stripe.mutex);
+            auto it = stripe.entries.find(key);
+            if (it == stripe.entries.end()) return false;
+            visit(it->second);
+            return true;
+        }
+
+        /// Remove and return every entry matching `match(key, value)`; walks all the stripes
+        template<typename Predicate>
+        std::vector<std::pair<Key, Value>> RemoveIf(Predicate&& match) {
+            std::vector<std::pair<Key, Value>> removed;
+            for (auto& stripe : stripes_) {
+                std::lock_guard<std::mutex> lock(stripe.mutex);
+                for (auto it = stripe.entries.begin(); it != stripe.entries.end();) {
+                    if (match(it->first, it->second)) {
+                        removed.emplace_back(it->first, std::move(it->second));
+                        it = stripe.entries.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+            }
+            return removed;
+        }
+
+    private:
+        using Map = std::unordered_map<Key, Value, Hash>;
+
+        struct Stripe {
+            std::mutex mutex;
+            Map entries;
+            std::vector<typename Map::node_type> spare;
+        };
+
+        static void Recycle(Stripe& stripe, typename Map::node_type node) {
+            if (stripe.spare.size() >= STRIPED_MAP_SPARE_NODES) return;
+            node.mapped() = Value(); // whatever the value holds on to is released now, not on reuse
+            stripe.spare.push_back(std::move(node));
+        }
+
+        Stripe& StripeOf(const Key& key) {
+            // the buckets use the low bits of the hash, the stripes use the mixed high ones
+            uint64_t mixed = static_cast<uint64_t>(Hash()(key)) * 0x9E3779B97F4A7C15ull;
+            return stripes_[(mixed >> 32) % STRIPED_MAP_STRIPES];
+        }
+
+        std::array<Stripe, STRIPED_MAP_STRIPES> stripes_;
+    };
+
+}
+
+#endif //MCP_SERVER_STRIPED_MAP_H
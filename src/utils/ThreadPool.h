@@ -0,0 +1,120 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef MCP_SERVER_THREAD_POOL_H
+#define MCP_SERVER_THREAD_POOL_H
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <condition_variable>
+
+namespace vx::utils {
+
+    /// Fixed size pool of worker threads consuming a FIFO of tasks.
+    /// Shutdown() drains the tasks already submitted before joining the workers.
+    class ThreadPool {
+    public:
+        explicit ThreadPool(size_t threads) {
+            if (threads == 0) threads = 1;
+            workers_.reserve(threads);
+            for (size_t i = 0; i < threads; i++) {
+                workers_.emplace_back([this]() { WorkerLoop(); });
+            }
+        }
+
+        ~ThreadPool() {
+            Shutdown();
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+        ThreadPool(ThreadPool&&) = delete;
+        ThreadPool& operator=(ThreadPool&&) = delete;
+
+        bool Submit(std::function<void()> task) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (stopping_) return false;
+                tasks_.push(std::move(task));
+            }
+            cv_.notify_one();
+            return true;
+        }
+
+        void Shutdown() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (stopping_) return;
+                stopping_ = true;
+            }
+            cv_.notify_all();
+            for (auto& worker : workers_) {
+                if (worker.joinable()) {
+                    if (worker.get_id() == std::this_thread::get_id()) {
+                        worker.detach(); // Shutdown called from inside a task
+                    } else {
+                        worker.join();
+                    }
+                }
+            }
+        }
+
+        inline size_t Size() const { return workers_.size(); }
+
+        // The calling thread is one of the workers, e.g. a task submitting more work
+        bool InWorker() const {
+            for (const auto& worker : workers_) {
+                if (worker.get_id() == std::this_thread::get_id()) return true;
+            }
+            return false;
+        }
+
+    private:
+        void WorkerLoop() {
+            while (true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+                    if (stopping_ && tasks_.empty()) return;
+                    task = std::move(tasks_.front());
+                    tasks_.pop();
+                }
+                task();
+            }
+        }
+
+        std::vector<std::thread> workers_;
+        std::queue<std::function<void()>> tasks_;
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        bool stopping_ = false;
+    };
+
+}
+
+#endif //MCP_SERVER_THREAD_POOL_H
@@ -0,0 +1,61 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef MCP_SERVER_BENCH_BENCH_H
+#define MCP_SERVER_BENCH_BENCH_H
+
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <algorithm>
+
+// Helpers shared by the microbenchmarks. They are run by hand (not by ctest) on an otherwise
+// idle machine, from a Release build: cmake -DCMAKE_BUILD_TYPE=Release.
+
+namespace vx::bench {
+
+    using Clock = std::chrono::steady_clock;
+
+    inline double SecondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    /// `p` in [0, 100]; sorts `samples`
+    inline double Percentile(std::vector<double>& samples, double p) {
+        if (samples.empty()) return 0;
+        std::sort(samples.begin(), samples.end());
+        size_t rank = static_cast<size_t>(p / 100.0 * static_cast<double>(samples.size() - 1));
+        return samples[rank];
+    }
+
+    /// Size of the run: the first command line argument scales the default
+    inline double Scale(int argc, char** argv) {
+        double scale = argc > 1 ? std::atof(argv[1]) : 1.0;
+        return scale > 0 ? scale : 1.0;
+    }
+
+}
+
+#endif //MCP_SERVER_BENCH_BENCH_H
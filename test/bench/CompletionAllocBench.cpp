@@ -0,0 +1,110 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+// Completion of a POST by the HTTP stream transport (user-017): heap allocations per request
+// for registering it, handing it its response and taking it back, with the recycled slots of
+// the striped table and with the shared_ptr<PendingRequest> + std::promise it replaced.
+// Allocations are counted by replacing the global operator new of this program.
+
+#include <new>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+#include "Bench.h"
+#include "Pending.h"
+
+static std::atomic<size_t> allocations {0};
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+
+using namespace vx::bench;
+
+struct PromisedRequest {
+    std::promise<std::string> promise;
+};
+
+int main(int argc, char** argv) {
+    auto requests = static_cast<int64_t>(200000 * Scale(argc, argv));
+    auto exchange = std::make_shared<Exchange>();
+    auto session = std::make_shared<Session>();
+    session->token = 1;
+    const std::string response(512, 'r'); // produced by the server, not counted below
+
+    // recycled slots: the exchange gets the response moved in
+    PendingTable slots;
+    for (int64_t id = -1000; id < 0; id++) { // warm up: fills the spare nodes
+        slots.Insert(Key(session->token, id), {exchange, session});
+        slots.Take(Key(session->token, id));
+    }
+    size_t start = allocations.load();
+    auto begin = Clock::now();
+    for (int64_t id = 0; id < requests; id++) {
+        std::string produced = response;
+        allocations.fetch_sub(1, std::memory_order_relaxed); // the response itself
+        slots.Insert(Key(session->token, id), {exchange, session});
+        auto pending = slots.Take(Key(session->token, id));
+        pending->exchange->response = std::move(produced);
+    }
+    double slotSeconds = SecondsSince(begin);
+    double slotAllocations = static_cast<double>(allocations.load() - start) / static_cast<double>(requests);
+
+    // shared state per request, response copied into the promise and out of the future
+    std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<PromisedRequest>> promised;
+    start = allocations.load();
+    begin = Clock::now();
+    for (int64_t id = 0; id < requests; id++) {
+        std::string produced = response;
+        allocations.fetch_sub(1, std::memory_order_relaxed); // the response itself
+        auto pending = std::make_shared<PromisedRequest>();
+        auto future = pending->promise.get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            promised.emplace(std::to_string(id), pending);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = promised.find(std::to_string(id));
+            it->second->promise.set_value(produced);
+            promised.erase(it);
+        }
+        exchange->response = future.get();
+    }
+    double promiseSeconds = SecondsSince(begin);
+    double promiseAllocations = static_cast<double>(allocations.load() - start) / static_cast<double>(requests);
+
+    std::printf("%-20s %16s %14s\n", "completion", "allocs/request", "ns/request");
+    std::printf("%-20s %16.2f %14.0f\n", "recycled slot", slotAllocations, slotSeconds * 1e9 / static_cast<double>(requests));
+    std::printf("%-20s %16.2f %14.0f\n", "shared_ptr+promise", promiseAllocations, promiseSeconds * 1e9 / static_cast<double>(requests));
+    return 0;
+}
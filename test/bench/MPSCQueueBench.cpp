@@ -0,0 +1,120 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+// Outbound message queue of the server (user-002): messages/s through one consumer and the
+// latency of an enqueue, for the lock-free MPSC ring and for a mutex-protected std::queue
+// with a condition variable, the way the writer was fed before.
+
+#include <queue>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <cstdio>
+#include <condition_variable>
+#include "Bench.h"
+#include "Message.h"
+#include "utils/MPSCQueue.h"
+
+using vx::OutboundMessage;
+using vx::bench::Clock;
+
+#define BENCH_QUEUE_CAPACITY 4096   // as OUTPUT_QUEUE_CAPACITY
+
+class MutexQueue {
+public:
+    bool Push(OutboundMessage&& message) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push(std::move(message));
+        }
+        ready_.notify_one();
+        return true;
+    }
+
+    bool WaitPop(OutboundMessage& message) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_.wait(lock, [this]() { return !queue_.empty(); });
+        message = std::move(queue_.front());
+        queue_.pop();
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::queue<OutboundMessage> queue_;
+};
+
+template<typename Queue>
+static void Run(const char* name, Queue& queue, int producers, size_t total) {
+    size_t perProducer = total / producers;
+    std::vector<std::vector<double>> latencies(producers);
+    std::atomic<bool> go {false};
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p]() {
+            auto& samples = latencies[p];
+            samples.reserve(perProducer);
+            std::string payload(120, 'x'); // about the size of a progress notification
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (size_t i = 0; i < perProducer; i++) {
+                OutboundMessage message(OutboundMessage::Kind::Notification, {}, payload, 0);
+                auto start = Clock::now();
+                queue.Push(std::move(message));
+                samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+            }
+        });
+    }
+
+    auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    OutboundMessage message;
+    size_t bytes = 0;
+    for (size_t received = 0; received < perProducer * producers; received++) {
+        queue.WaitPop(message);
+        bytes += message.payload.size();
+    }
+    double seconds = vx::bench::SecondsSince(start);
+    for (auto& thread : threads) thread.join();
+
+    std::vector<double> all;
+    for (auto& samples : latencies) all.insert(all.end(), samples.begin(), samples.end());
+    std::printf("%-12s %9d %14.0f %14.0f %14.0f\n", name, producers,
+                static_cast<double>(perProducer * producers) / seconds,
+                vx::bench::Percentile(all, 50), vx::bench::Percentile(all, 99));
+    if (bytes == 0) std::printf("nothing received\n");
+}
+
+int main(int argc, char** argv) {
+    auto total = static_cast<size_t>(2000000 * vx::bench::Scale(argc, argv));
+    std::printf("%-12s %9s %14s %14s %14s\n", "queue", "producers", "messages/s", "p50 push ns", "p99 push ns");
+    for (int producers : {1, 2, 4, 8}) {
+        vx::utils::MPSCQueue<OutboundMessage> ring(BENCH_QUEUE_CAPACITY);
+        Run("mpsc-ring", ring, producers, total);
+        MutexQueue locked;
+        Run("mutex+cv", locked, producers, total);
+    }
+    return 0;
+}
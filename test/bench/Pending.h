@@ -0,0 +1,53 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef MCP_SERVER_BENCH_PENDING_H
+#define MCP_SERVER_BENCH_PENDING_H
+
+#include <string>
+#include <cstdint>
+#include "utils/PendingTable.h"
+
+// The table of POSTs waiting for their response, the one HttpStream keeps (utils/PendingTable.h),
+// with stand-ins for the exchange to answer on and the session.
+
+namespace vx::bench {
+
+    struct Exchange { std::string response; };
+    struct Session { uint64_t token = 0; };
+
+    using PendingKey = vx::utils::PendingKey;
+    using PendingRequest = vx::utils::PendingRequest<Exchange, Session>;
+    using PendingTable = vx::utils::PendingTable<Exchange, Session>;
+
+    inline PendingKey Key(uint64_t session, int64_t number) {
+        PendingKey key {session, {}};
+        key.id.type = vx::MessageId::Type::Number;
+        key.id.number = number;
+        return key;
+    }
+
+}
+
+#endif //MCP_SERVER_BENCH_PENDING_H
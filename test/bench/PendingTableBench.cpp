@@ -0,0 +1,111 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+// Pending-request table of the HTTP stream transport (user-016): POSTs/s when many threads
+// register a request and take it back when its response is written, with the lock-striped
+// table keyed by (session, id) and with the single mutex-protected map keyed by the id
+// formatted as a string that it replaced.
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <cstdio>
+#include <unordered_map>
+#include "Bench.h"
+#include "Pending.h"
+
+using namespace vx::bench;
+
+class StripedTable {
+public:
+    bool Add(uint64_t session, int64_t id, PendingRequest request) {
+        return map_.Insert(Key(session, id), std::move(request));
+    }
+    bool Complete(uint64_t session, int64_t id) {
+        auto pending = map_.Take(Key(session, id));
+        return pending.has_value();
+    }
+
+private:
+    PendingTable map_;
+};
+
+class GlobalTable {
+public:
+    bool Add(uint64_t, int64_t id, PendingRequest request) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return map_.emplace(std::to_string(id), std::make_shared<PendingRequest>(std::move(request))).second;
+    }
+    bool Complete(uint64_t, int64_t id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return map_.erase(std::to_string(id)) > 0;
+    }
+
+private:
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<PendingRequest>> map_;
+};
+
+// Every thread is a client (its own session) posting requests with increasing ids; a POST is
+// registered, then completed, with a few requests of the thread in flight at any time
+template<typename Table>
+static double Run(int threads, size_t perThread) {
+    Table table;
+    auto exchange = std::make_shared<Exchange>();
+    std::atomic<bool> go {false};
+    std::atomic<size_t> failures {0};
+    std::vector<std::thread> clients;
+    for (int t = 0; t < threads; t++) {
+        clients.emplace_back([&, t]() {
+            auto session = std::make_shared<Session>();
+            session->token = static_cast<uint64_t>(t + 1);
+            // the global table knows no sessions: ids are kept apart across clients for it
+            int64_t base = static_cast<int64_t>(t) << 32;
+            constexpr int64_t inFlight = 8;
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (int64_t i = 0; i < static_cast<int64_t>(perThread); i++) {
+                if (!table.Add(session->token, base + i, {exchange, session})) failures++;
+                if (i >= inFlight && !table.Complete(session->token, base + i - inFlight)) failures++;
+            }
+            for (int64_t i = static_cast<int64_t>(perThread) - inFlight; i < static_cast<int64_t>(perThread); i++) {
+                if (!table.Complete(session->token, base + i)) failures++;
+            }
+        });
+    }
+    auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& client : clients) client.join();
+    double seconds = SecondsSince(start);
+    if (failures) std::printf("%zu failed operations\n", failures.load());
+    return static_cast<double>(perThread * threads) / seconds;
+}
+
+int main(int argc, char** argv) {
+    auto perThread = static_cast<size_t>(500000 * Scale(argc, argv));
+    std::printf("%8s %16s %16s\n", "threads", "striped POST/s", "global POST/s");
+    for (int threads : {1, 2, 4, 8, 16}) {
+        std::printf("%8d %16.0f %16.0f\n", threads, Run<StripedTable>(threads, perThread), Run<GlobalTable>(threads, perThread));
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+// Per-plugin scheduling (user-025): calls/s into a plugin from the dispatch threads for each
+// concurrency mode it may declare, the way PluginRequest admits them (PluginGate::Post to the
+// plugin's threads unless it is reentrant, PluginGate::Enter there). The handler spins for a
+// fixed time, like a plugin computing its result; the run lasts until every call is done.
+
+#include <atomic>
+#include <thread>
+#include <cstdio>
+#include <utility>
+#include <algorithm>
+#include "Bench.h"
+#include "loader/PluginGate.h"
+
+using vx::bench::Clock;
+using vx::mcp::PluginGate;
+
+static void Handler(std::chrono::nanoseconds work) {
+    auto until = Clock::now() + work;
+    while (Clock::now() < until) {}
+}
+
+static double Run(PluginConcurrency concurrency, int threads, size_t perThread, std::chrono::nanoseconds work) {
+    std::atomic<size_t> remaining {perThread * static_cast<size_t>(threads)};
+    std::atomic<bool> go {false};
+    PluginGate gate(concurrency);
+    std::vector<std::thread> dispatchers;
+    for (int t = 0; t < threads; t++) {
+        dispatchers.emplace_back([&]() {
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (size_t i = 0; i < perThread; i++) {
+                gate.Post([&gate, &remaining, work]() {
+                    auto slot = gate.Enter();
+                    Handler(work);
+                    remaining.fetch_sub(1, std::memory_order_release);
+                });
+            }
+        });
+    }
+    auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& dispatcher : dispatchers) dispatcher.join();
+    while (remaining.load(std::memory_order_acquire) > 0) std::this_thread::yield();
+    return static_cast<double>(perThread * threads) / vx::bench::SecondsSince(start);
+}
+
+int main(int argc, char** argv) {
+    auto perThread = static_cast<size_t>(20000 * vx::bench::Scale(argc, argv));
+    int threads = static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+    const std::pair<const char*, PluginConcurrency> modes[] = {
+            {"reentrant", {PLUGIN_CONCURRENCY_REENTRANT, 0}},
+            {"limited to 4", {PLUGIN_CONCURRENCY_LIMITED, 4}},
+            {"limited to 2", {PLUGIN_CONCURRENCY_LIMITED, 2}},
+            {"serialized", {PLUGIN_CONCURRENCY_SERIALIZED, 1}},
+            {"thread-affine", {PLUGIN_CONCURRENCY_THREAD_AFFINE, 0}},
+    };
+
+    std::printf("%d dispatch threads\n", threads);
+    std::printf("%-14s %16s %16s\n", "mode", "calls/s (0 us)", "calls/s (20 us)");
+    for (const auto& [name, concurrency] : modes) {
+        double empty = Run(concurrency, threads, perThread, std::chrono::nanoseconds(0));
+        double busy = Run(concurrency, threads, perThread / 10, std::chrono::microseconds(20));
+        std::printf("%-14s %16.0f %16.0f\n", name, empty, busy);
+    }
+    return 0;
+}
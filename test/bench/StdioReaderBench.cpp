@@ -0,0 +1,91 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+// Stdio reader (user-011): MB/s reading newline-delimited messages from fd 0 with the block
+// reader of the Stdio transport, and with the getc() loop it replaced. The input is a temporary
+// file put in place of stdin, once with small messages and once with large ones.
+
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+#include "Bench.h"
+#include "StdioTransport.h"
+
+// How Stdio::Read used to build a message: one locked libc call and one append per byte
+static std::string GetcRead() {
+    std::string json_data;
+    int c;
+    while ((c = std::getc(stdin)) != EOF && c != '\n') {
+        json_data += static_cast<char>(c);
+    }
+    return json_data;
+}
+
+static void Rewind() {
+    ::lseek(STDIN_FILENO, 0, SEEK_SET);
+    std::rewind(stdin);
+}
+
+static void Run(const char* input, size_t messageSize, size_t totalBytes) {
+    // a tools/call request carrying a large argument, e.g. a pasted file
+    std::string head = R"({"jsonrpc":"2.0","id":1,"method":"tools/call","params":{"name":"x","arguments":{"text":")";
+    std::string tail = R"("}}})";
+    std::string message = head + std::string(messageSize - head.size() - tail.size(), 'a') + tail + "\n";
+    size_t count = totalBytes / message.size();
+
+    std::FILE* file = std::tmpfile();
+    for (size_t i = 0; i < count; i++) std::fwrite(message.data(), 1, message.size(), file);
+    std::fflush(file);
+    ::dup2(::fileno(file), STDIN_FILENO);
+    double megabytes = static_cast<double>(count * message.size()) / (1024.0 * 1024.0);
+
+    Rewind();
+    size_t read = 0;
+    auto start = vx::bench::Clock::now();
+    {
+        vx::transport::Stdio stdio;
+        while (!stdio.Read().Empty()) read++;
+    }
+    double blocks = megabytes / vx::bench::SecondsSince(start);
+
+    Rewind();
+    size_t readGetc = 0;
+    start = vx::bench::Clock::now();
+    while (!GetcRead().empty()) readGetc++;
+    double getc = megabytes / vx::bench::SecondsSince(start);
+
+    std::printf("%-10s %10zu %12.0f %12.0f %8.1fx%s\n", input, count, blocks, getc, blocks / getc,
+                read == count && readGetc == count ? "" : "  (message count mismatch)");
+    std::fclose(file);
+}
+
+int main(int argc, char** argv) {
+    double scale = vx::bench::Scale(argc, argv);
+    auto total = static_cast<size_t>(256.0 * 1024 * 1024 * scale);
+    std::printf("%-10s %10s %12s %12s %9s\n", "messages", "count", "block MB/s", "getc MB/s", "speedup");
+    Run("200 B", 200, total / 4);
+    Run("64 KiB", 64 * 1024, total);
+    Run("4 MiB", 4 * 1024 * 1024, total);
+    return 0;
+}
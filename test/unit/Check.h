@@ -0,0 +1,59 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef MCP_SERVER_TEST_CHECK_H
+#define MCP_SERVER_TEST_CHECK_H
+
+#include <iostream>
+
+// Minimal assertions for the unit checks: a failed check is reported and the test goes on,
+// the process exit code tells ctest whether everything held.
+
+namespace vx::test {
+
+    inline int failures = 0;
+
+    inline bool Check(bool condition, const char* expression, const char* file, int line) {
+        if (!condition) {
+            failures++;
+            std::cerr << file << ":" << line << ": check failed: " << expression << std::endl;
+        }
+        return condition;
+    }
+
+    inline int Report(const char* name) {
+        if (failures == 0) {
+            std::cout << name << ": all checks passed" << std::endl;
+            return 0;
+        }
+        std::cerr << name << ": " << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+
+}
+
+#define CHECK(condition) vx::test::Check((condition), #condition, __FILE__, __LINE__)
+#define CHECK_EQ(actual, expected) vx::test::Check((actual) == (expected), #actual " == " #expected, __FILE__, __LINE__)
+
+#endif //MCP_SERVER_TEST_CHECK_H
@@ -0,0 +1,170 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <string>
+#include "Check.h"
+#include "utils/MPSCQueue.h"
+
+using vx::utils::MPSCQueue;
+
+static void CapacityIsRoundedToAPowerOfTwo() {
+    MPSCQueue<int> queue(100);
+    CHECK_EQ(queue.Capacity(), 128u);
+}
+
+static void PopsInPushOrder() {
+    MPSCQueue<std::string> queue(8);
+    for (int i = 0; i < 5; i++) CHECK(queue.TryPush(std::to_string(i)));
+    std::string value;
+    for (int i = 0; i < 5; i++) {
+        CHECK(queue.TryPop(value));
+        CHECK_EQ(value, std::to_string(i));
+    }
+    CHECK(!queue.TryPop(value));
+}
+
+static void RefusesWhenFull() {
+    MPSCQueue<int> queue(4);
+    for (int i = 0; i < 4; i++) CHECK(queue.TryPush(int(i)));
+    CHECK(!queue.TryPush(4));
+    int value = -1;
+    CHECK(queue.TryPop(value));
+    CHECK_EQ(value, 0);
+    CHECK(queue.TryPush(4)); // the freed cell is reused
+}
+
+static void CloseDrainsThenStops() {
+    MPSCQueue<int> queue(8);
+    CHECK(queue.Push(1));
+    CHECK(queue.Push(2));
+    queue.Close();
+    CHECK(!queue.Push(3));
+    int value = 0;
+    CHECK(queue.WaitPop(value));
+    CHECK_EQ(value, 1);
+    CHECK(queue.WaitPop(value));
+    CHECK_EQ(value, 2);
+    CHECK(!queue.WaitPop(value));
+
+    queue.Reopen();
+    CHECK(queue.Push(4));
+    CHECK(queue.WaitPop(value));
+    CHECK_EQ(value, 4);
+}
+
+static void CloseWakesAWaitingConsumer() {
+    MPSCQueue<int> queue(8);
+    bool popped = true;
+    std::thread consumer([&]() {
+        int value;
+        popped = queue.WaitPop(value);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.Close();
+    consumer.join();
+    CHECK(!popped);
+}
+
+// every message of every producer arrives once, and those of one producer in the order it pushed them
+static void ProducersKeepTheirOrder() {
+    constexpr int producers = 4;
+    constexpr int perProducer = 50000;
+    MPSCQueue<std::pair<int, int>> queue(64); // small: producers have to wait for the consumer
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&queue, p]() {
+            for (int i = 0; i < perProducer; i++) queue.Push({p, i});
+        });
+    }
+
+    std::vector<int> next(producers, 0);
+    bool ordered = true;
+    std::pair<int, int> message;
+    for (int received = 0; received < producers * perProducer; received++) {
+        if (!queue.WaitPop(message)) break;
+        ordered = ordered && message.second == next[message.first];
+        next[message.first] = message.second + 1;
+    }
+    for (auto& thread : threads) thread.join();
+
+    CHECK(ordered);
+    for (int p = 0; p < producers; p++) CHECK_EQ(next[p], perProducer);
+    CHECK(!queue.TryPop(message));
+}
+
+// a push that reported success is never lost, even when it races with Close()
+static void CloseKeepsEveryAcceptedPush() {
+    for (int round = 0; round < 200; round++) {
+        MPSCQueue<int> queue(1024);
+        std::atomic<int> accepted {0};
+        std::vector<std::thread> threads;
+        for (int p = 0; p < 4; p++) {
+            threads.emplace_back([&]() {
+                for (int i = 0; i < 64; i++) {
+                    if (queue.Push(int(i))) accepted++;
+                }
+            });
+        }
+        queue.Close();
+        for (auto& thread : threads) thread.join();
+
+        int received = 0;
+        int value;
+        while (queue.WaitPop(value)) received++;
+        CHECK_EQ(received, accepted.load());
+    }
+}
+
+// a producer blocked on a full ring resumes as soon as the consumer frees a cell
+static void PushSleepsUntilThereIsRoom() {
+    MPSCQueue<int> queue(2);
+    CHECK(queue.Push(0));
+    CHECK(queue.Push(1));
+    std::atomic<bool> pushed {false};
+    std::thread producer([&]() {
+        pushed = queue.Push(2);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(!pushed.load());
+    int value;
+    CHECK(queue.TryPop(value));
+    producer.join();
+    CHECK(pushed.load());
+}
+
+int main() {
+    CapacityIsRoundedToAPowerOfTwo();
+    PopsInPushOrder();
+    RefusesWhenFull();
+    CloseDrainsThenStops();
+    CloseWakesAWaitingConsumer();
+    ProducersKeepTheirOrder();
+    CloseKeepsEveryAcceptedPush();
+    PushSleepsUntilThereIsRoom();
+    return vx::test::Report("MPSCQueue");
+}
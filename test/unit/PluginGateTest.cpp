@@ -0,0 +1,200 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
+#include "Check.h"
+#include "loader/PluginGate.h"
+
+using vx::mcp::PluginGate;
+
+// Most calls in flight at once through `gate` when `threads` threads call it together
+static int PeakConcurrency(PluginGate& gate, int threads) {
+    std::atomic<int> active {0};
+    std::atomic<int> peak {0};
+    std::vector<std::thread> callers;
+    for (int t = 0; t < threads; t++) {
+        callers.emplace_back([&]() {
+            for (int i = 0; i < 5; i++) {
+                auto slot = gate.Enter();
+                int now = ++active;
+                int seen = peak.load();
+                while (now > seen && !peak.compare_exchange_weak(seen, now)) {}
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                --active;
+            }
+        });
+    }
+    for (auto& caller : callers) caller.join();
+    return peak.load();
+}
+
+static void SerializedLetsOneCallIn() {
+    PluginGate gate({PLUGIN_CONCURRENCY_SERIALIZED, 0});
+    CHECK_EQ(PeakConcurrency(gate, 6), 1);
+    CHECK_EQ(gate.Describe(), "serialized");
+}
+
+static void LimitedLetsUpToItsLimitIn() {
+    PluginGate gate({PLUGIN_CONCURRENCY_LIMITED, 3});
+    int peak = PeakConcurrency(gate, 8);
+    CHECK(peak >= 2 && peak <= 3);
+
+    PluginGate atLeastOne({PLUGIN_CONCURRENCY_LIMITED, 0});
+    CHECK_EQ(atLeastOne.Concurrency().limit, 1);
+}
+
+static void ReentrantNeverWaits() {
+    PluginGate gate({PLUGIN_CONCURRENCY_REENTRANT, 0});
+    CHECK(PeakConcurrency(gate, 6) > 1);
+}
+
+static void UnknownModesAreSerialized() {
+    PluginGate gate({static_cast<PluginConcurrencyMode>(42), 9});
+    CHECK_EQ(gate.Concurrency().mode, PLUGIN_CONCURRENCY_SERIALIZED);
+    CHECK_EQ(PeakConcurrency(gate, 4), 1);
+}
+
+static void SlotIsHeldByItsLastCopy() {
+    PluginGate gate({PLUGIN_CONCURRENCY_SERIALIZED, 1});
+    auto slot = gate.Enter();
+    auto copy = slot; // e.g. held by the completion of an asynchronous call
+    slot.reset();
+
+    std::atomic<bool> entered {false};
+    std::thread other([&]() {
+        auto next = gate.Enter();
+        entered = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(!entered);
+    copy.reset();
+    other.join();
+    CHECK(entered);
+}
+
+static void ThreadAffineRunsOnOneThread() {
+    PluginGate gate({PLUGIN_CONCURRENCY_THREAD_AFFINE, 0});
+    CHECK(gate.ThreadAffine());
+
+    std::thread::id first;
+    gate.Run([&]() { first = std::this_thread::get_id(); });
+    CHECK(first != std::this_thread::get_id());
+
+    bool same = true;
+    std::vector<std::thread> callers;
+    std::mutex mutex;
+    for (int t = 0; t < 4; t++) {
+        callers.emplace_back([&]() {
+            gate.Run([&]() {
+                std::lock_guard<std::mutex> lock(mutex);
+                same = same && std::this_thread::get_id() == first;
+                // calls made from the plugin thread run inline instead of waiting for themselves
+                gate.Run([&]() { same = same && std::this_thread::get_id() == first; });
+            });
+        });
+    }
+    for (auto& caller : callers) caller.join();
+    CHECK(same);
+
+    bool rethrown = false;
+    try {
+        gate.Run([]() { throw std::runtime_error("plugin failed"); });
+    } catch (const std::runtime_error&) {
+        rethrown = true;
+    }
+    CHECK(rethrown);
+}
+
+// a serialized plugin busy with a slow call queues the next ones: the callers move on
+static void PostNeverWaitsForTheCall() {
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool release = false;
+    std::vector<int> order;
+    PluginGate gate({PLUGIN_CONCURRENCY_SERIALIZED, 1}); // joined first: its calls use the above
+    CHECK(gate.Queued());
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 3; i++) {
+        CHECK(gate.Post([&, i]() {
+            auto slot = gate.Enter();
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&]() { return release; });
+            order.push_back(i);
+            changed.notify_all();
+        }));
+    }
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(100));
+
+    std::unique_lock<std::mutex> lock(mutex);
+    release = true;
+    changed.notify_all();
+    changed.wait(lock, [&]() { return order.size() == 3; });
+    CHECK(order == std::vector<int>({0, 1, 2}));
+}
+
+// a limited plugin gets as many threads as it takes calls, a reentrant one is called right away
+static void PostRunsWhereThePluginTakesCalls() {
+    std::mutex mutex;
+    std::condition_variable changed;
+    int running = 0;
+    PluginGate limited({PLUGIN_CONCURRENCY_LIMITED, 2});
+    for (int i = 0; i < 2; i++) {
+        // each call waits for the other one: they only both finish when they run side by side
+        limited.Post([&]() {
+            std::unique_lock<std::mutex> lock(mutex);
+            running++;
+            changed.notify_all();
+            changed.wait_for(lock, std::chrono::seconds(5), [&]() { return running == 2; });
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        CHECK(changed.wait_for(lock, std::chrono::seconds(1), [&]() { return running == 2; }));
+    }
+
+    PluginGate reentrant({PLUGIN_CONCURRENCY_REENTRANT, 0});
+    CHECK(!reentrant.Queued());
+    std::thread::id ran;
+    CHECK(reentrant.Post([&]() { ran = std::this_thread::get_id(); }));
+    CHECK(ran == std::this_thread::get_id());
+}
+
+int main() {
+    SerializedLetsOneCallIn();
+    LimitedLetsUpToItsLimitIn();
+    ReentrantNeverWaits();
+    UnknownModesAreSerialized();
+    SlotIsHeldByItsLastCopy();
+    ThreadAffineRunsOnOneThread();
+    PostNeverWaitsForTheCall();
+    PostRunsWhereThePluginTakesCalls();
+    return vx::test::Report("PluginGate");
+}
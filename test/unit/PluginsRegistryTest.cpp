@@ -0,0 +1,131 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <string>
+#include <vector>
+#include <memory>
+#include "Check.h"
+#include "json.hpp"
+#include "loader/PluginsLoader.h"
+#include "loader/PluginsRegistry.h"
+
+using vx::mcp::PluginEntry;
+using vx::mcp::PluginsRegistry;
+
+// Two tool plugins sharing one tool name, and a plugin of each other kind. Plugins are plain
+// function tables, so the data behind them lives in globals.
+namespace {
+    std::vector<std::string> manyNames;
+    std::vector<PluginTool> manyTools;
+
+    const PluginTool otherTools[] = {
+            {"tool_7", "shadowed by the first plugin", R"({"type":"object"})"},
+            {"broken", "schema is not JSON", "{not json"},
+    };
+    const PluginPrompt prompts[] = {{"greet", "say hello", R"([{"name":"who"}])"}};
+    const PluginResource resources[] = {{"readme", "the readme", "file:///README.md", "text/markdown"}};
+
+    PluginAPI Plugin(const char* (*name)(), PluginType (*type)()) {
+        PluginAPI api {};
+        api.GetName = name;
+        api.GetType = type;
+        return api;
+    }
+
+    PluginEntry Entry(PluginAPI& api) {
+        PluginEntry entry {};
+        entry.instance = &api;
+        entry.abiVersion = PLUGIN_ABI_VERSION;
+        entry.gate = std::make_shared<vx::mcp::PluginGate>(PluginConcurrency{PLUGIN_CONCURRENCY_REENTRANT, 0});
+        return entry;
+    }
+}
+
+int main() {
+    for (int i = 0; i < 100; i++) manyNames.push_back("tool_" + std::to_string(i));
+    for (const auto& name : manyNames) manyTools.push_back({name.c_str(), "one of many", R"({"type":"object"})"});
+
+    PluginAPI many = Plugin([]() { return "many"; }, []() { return PLUGIN_TYPE_TOOLS; });
+    many.GetToolCount = []() { return static_cast<int>(manyTools.size()); };
+    many.GetTool = [](int index) -> const PluginTool* { return &manyTools[index]; };
+
+    PluginAPI other = Plugin([]() { return "other"; }, []() { return PLUGIN_TYPE_TOOLS; });
+    other.GetToolCount = []() { return 2; };
+    other.GetTool = [](int index) { return &otherTools[index]; };
+
+    PluginAPI prompter = Plugin([]() { return "prompter"; }, []() { return PLUGIN_TYPE_PROMPTS; });
+    prompter.GetPromptCount = []() { return 1; };
+    prompter.GetPrompt = [](int index) { return &prompts[index]; };
+
+    PluginAPI files = Plugin([]() { return "files"; }, []() { return PLUGIN_TYPE_RESOURCES; });
+    files.GetResourceCount = []() { return 1; };
+    files.GetResource = [](int index) { return &resources[index]; };
+
+    std::vector<PluginEntry> plugins {Entry(many), Entry(other), Entry(prompter), Entry(files)};
+    PluginsRegistry registry(plugins);
+
+    // every tool is found, with the index to call it with
+    bool allFound = true;
+    for (int i = 0; i < 100; i++) {
+        auto entry = registry.FindTool(manyNames[i]);
+        allFound = allFound && entry && entry->plugin == &many && entry->index == i && entry->key == manyNames[i];
+    }
+    CHECK(allFound);
+    CHECK(registry.FindTool("tool_100") == nullptr);
+    CHECK(registry.FindTool("") == nullptr);
+
+    // the first plugin declaring a name keeps it
+    CHECK(registry.FindTool("tool_7")->plugin == &many);
+    CHECK(registry.FindTool("broken")->plugin == &other);
+    CHECK_EQ(registry.FindTool("broken")->index, 1);
+    CHECK_EQ(registry.Tools().size(), 101u);
+    CHECK(registry.FindTool("broken")->gate == plugins[1].gate.get());
+
+    CHECK(registry.FindPrompt("greet") && registry.FindPrompt("greet")->plugin == &prompter);
+    CHECK(registry.FindPrompt("tool_1") == nullptr);
+    CHECK(registry.FindResource("file:///README.md") && registry.FindResource("file:///README.md")->plugin == &files);
+    CHECK(registry.FindResource("readme") == nullptr); // resources go by uri
+
+    // list results, in load order, with declared JSON parsed once
+    auto tools = nlohmann::json::parse(registry.ToolsListResult())["tools"];
+    CHECK_EQ(tools.size(), 101u);
+    CHECK_EQ(tools[0]["name"], "tool_0");
+    CHECK_EQ(tools[100]["name"], "broken");
+    CHECK_EQ(tools[100]["inputSchema"], nlohmann::json::object());
+    CHECK_EQ(tools[3]["inputSchema"]["type"], "object");
+
+    auto promptList = nlohmann::json::parse(registry.PromptsListResult())["prompts"];
+    CHECK_EQ(promptList.size(), 1u);
+    CHECK_EQ(promptList[0]["arguments"][0]["name"], "who");
+
+    auto resourceList = nlohmann::json::parse(registry.ResourcesListResult())["resources"];
+    CHECK_EQ(resourceList.size(), 1u);
+    CHECK_EQ(resourceList[0]["mimeType"], "text/markdown");
+
+    PluginsRegistry empty({});
+    CHECK(empty.FindTool("tool_0") == nullptr);
+    CHECK_EQ(empty.ToolsListResult(), R"({"tools":[]})");
+
+    return vx::test::Report("PluginsRegistry");
+}
@@ -0,0 +1,123 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <memory>
+#include <string>
+#include "Check.h"
+#include "utils/ReplayRing.h"
+
+using vx::utils::ReplayRing;
+
+static ReplayRing::Payload Data(const char* text) {
+    return std::make_shared<const std::string>(text);
+}
+
+static void NumbersAndFramesEvents() {
+    ReplayRing ring;
+    std::string out;
+    CHECK_EQ(ring.Append(&out, {}, Data("a")), 1u);
+    CHECK_EQ(ring.Append(&out, "message", Data("b")), 2u);
+    CHECK_EQ(out, "id: 1\ndata: a\n\nid: 2\nevent: message\ndata: b\n\n");
+    CHECK_EQ(ring.LastId(), 2u);
+
+    // not framed when there is nobody to send it to, but numbered and kept
+    CHECK_EQ(ring.Append(nullptr, {}, Data("c")), 3u);
+    CHECK_EQ(out.size(), 45u);
+}
+
+static void ReplaysWhatCameAfter() {
+    ReplayRing ring;
+    for (const char* text : {"a", "b", "c"}) ring.Append(nullptr, {}, Data(text));
+
+    std::string out;
+    CHECK(ring.Replay(1, out));
+    CHECK_EQ(out, "id: 2\ndata: b\n\nid: 3\ndata: c\n\n");
+
+    out.clear();
+    CHECK(ring.Replay(3, out));
+    CHECK(out.empty());
+
+    out.clear();
+    CHECK(ring.Replay(0, out)); // from the start
+    CHECK_EQ(out.rfind("id: 1\n", 0), 0u);
+}
+
+static void ForgetsTheOldestPastCapacity() {
+    ReplayRing ring(4); // bytes of payload
+    for (const char* text : {"aa", "bb", "cc"}) ring.Append(nullptr, {}, Data(text));
+
+    std::string out;
+    CHECK(!ring.Replay(0, out)); // event 1 is gone
+    CHECK_EQ(out, "id: 2\ndata: bb\n\nid: 3\ndata: cc\n\n");
+
+    out.clear();
+    CHECK(ring.Replay(1, out)); // nothing missing after 1
+}
+
+static void KeepsNothingWithoutCapacity() {
+    ReplayRing ring(0);
+    std::string out;
+    CHECK_EQ(ring.Append(&out, {}, Data("a")), 1u);
+    CHECK_EQ(out, "id: 1\ndata: a\n\n");
+    out.clear();
+    CHECK(!ring.Replay(0, out));
+    CHECK(out.empty());
+}
+
+static void SplitsPayloadsIntoLines() {
+    ReplayRing ring;
+    std::string out;
+    ring.Append(&out, "message", Data("{\n  \"a\": 1\r\n}\r"));
+    CHECK_EQ(out, "id: 1\nevent: message\ndata: {\ndata:   \"a\": 1\ndata: }\ndata: \n\n");
+
+    out.clear();
+    ReplayRing::AppendData(out, "no break");
+    CHECK_EQ(out, "no break");
+}
+
+static void SharesPayloads() {
+    ReplayRing first, second;
+    auto payload = Data("broadcast");
+    first.Append(nullptr, {}, payload);
+    second.Append(nullptr, {}, payload);
+    CHECK_EQ(payload.use_count(), 3);
+}
+
+static void ParsesIds() {
+    CHECK_EQ(ReplayRing::ParseId("42"), 42u);
+    CHECK_EQ(ReplayRing::ParseId(""), 0u);
+    CHECK_EQ(ReplayRing::ParseId("4x"), 0u);
+    CHECK_EQ(ReplayRing::ParseId("-1"), 0u);
+}
+
+int main() {
+    NumbersAndFramesEvents();
+    ReplaysWhatCameAfter();
+    ForgetsTheOldestPastCapacity();
+    KeepsNothingWithoutCapacity();
+    SplitsPayloadsIntoLines();
+    SharesPayloads();
+    ParsesIds();
+    return vx::test::Report("ReplayRing");
+}
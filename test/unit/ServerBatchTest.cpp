@@ -0,0 +1,275 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include "Check.h"
+#include "json.hpp"
+#include "aixlog.hpp"
+#include "server/Server.h"
+
+using json = nlohmann::json;
+
+// Feeds the server a fixed list of messages, then reports the client gone; keeps what is written
+class ScriptedTransport : public vx::ITransport {
+public:
+    explicit ScriptedTransport(std::vector<std::string> messages) : messages_(messages.begin(), messages.end()) {}
+
+    bool Start() override { return true; }
+    void Stop() override {}
+    bool IsRunning() override { return true; }
+
+    vx::InboundMessage Read() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (messages_.empty()) return {};
+        vx::InboundMessage message(std::move(messages_.front()));
+        messages_.pop_front();
+        return message;
+    }
+
+    void Write(const vx::OutboundMessage& message) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        written_.push_back(json::parse(message.payload));
+    }
+
+    std::string GetName() override { return "scripted"; }
+    std::string GetVersion() override { return "1"; }
+    int GetPort() override { return 0; }
+
+    std::vector<json> Written() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return written_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::deque<std::string> messages_;
+    std::vector<json> written_;
+};
+
+// Takes responses written in pieces too, and remembers how the last one ended
+class StreamingTransport : public ScriptedTransport {
+public:
+    using ScriptedTransport::ScriptedTransport;
+
+    std::unique_ptr<vx::OutboundStream> OpenStream(uint64_t, const vx::MessageId&) override {
+        return std::make_unique<Stream>(*this);
+    }
+
+    std::string streamed;
+    bool closed = false;
+    bool aborted = false;
+
+private:
+    class Stream : public vx::OutboundStream {
+    public:
+        explicit Stream(StreamingTransport& owner) : owner_(owner) {}
+        bool Write(std::string_view data) override { owner_.streamed.append(data); return true; }
+        void Close() override { owner_.closed = true; }
+        void Abort() override { owner_.aborted = true; }
+    private:
+        StreamingTransport& owner_;
+    };
+};
+
+static std::vector<json> Run(int workers, std::vector<std::string> messages,
+                             const std::function<void(vx::mcp::Server&)>& setup = {}) {
+    vx::mcp::Server server;
+    server.Workers(workers);
+    if (setup) setup(server);
+    auto transport = std::make_shared<ScriptedTransport>(std::move(messages));
+    server.Connect(transport);
+    return transport->Written();
+}
+
+static void BatchRepliesInRequestOrder(int workers) {
+    auto written = Run(workers, {
+            R"([{"jsonrpc":"2.0","id":1,"method":"ping"},
+                {"jsonrpc":"2.0","method":"notifications/initialized"},
+                {"jsonrpc":"2.0","id":"b","method":"ping"},
+                {"jsonrpc":"2.0","id":3,"method":"no/such/method"}])"});
+    if (!CHECK_EQ(written.size(), 1u)) return;
+    const json& reply = written[0];
+    if (!CHECK(reply.is_array() && reply.size() == 3)) return;
+    CHECK_EQ(reply[0]["id"], 1);
+    CHECK(reply[0].contains("result"));
+    CHECK_EQ(reply[1]["id"], "b");
+    CHECK_EQ(reply[2]["id"], 3);
+    CHECK_EQ(reply[2]["error"]["code"], -32601);
+}
+
+static void BatchOfNotificationsIsNotAnswered() {
+    auto written = Run(2, {R"([{"jsonrpc":"2.0","method":"notifications/initialized"}])"});
+    CHECK(written.empty());
+}
+
+static void EmptyBatchIsAnError() {
+    auto written = Run(2, {"[]"});
+    if (!CHECK_EQ(written.size(), 1u)) return;
+    CHECK_EQ(written[0]["error"]["code"], -32600);
+}
+
+// elements without id are notifications, whatever else is wrong with them: never answered
+static void MalformedNotificationsAreNotAnswered() {
+    auto written = Run(2, {
+            R"([{"jsonrpc":"2.0"},
+                {"jsonrpc":"2.0","method":"no/such"},
+                {"jsonrpc":"2.0","method":42},
+                {"jsonrpc":"2.0","method":"ping"},
+                {"jsonrpc":"2.0","id":1,"method":"ping"}])",
+            R"({"jsonrpc":"2.0","method":"no/such"})",
+            R"({"jsonrpc":"2.0"})"});
+    if (!CHECK_EQ(written.size(), 1u)) return;
+    const json& reply = written[0];
+    if (!CHECK(reply.is_array() && reply.size() == 1)) return;
+    CHECK_EQ(reply[0]["id"], 1);
+}
+
+// requests with an id are answered with an error when their method is missing or not a string
+static void MalformedRequestsAreErrors() {
+    auto written = Run(2, {
+            R"([{"jsonrpc":"2.0","id":1},
+                {"jsonrpc":"2.0","id":2,"method":42},
+                7])"});
+    if (!CHECK_EQ(written.size(), 1u)) return;
+    const json& reply = written[0];
+    if (!CHECK(reply.is_array() && reply.size() == 3)) return;
+    CHECK_EQ(reply[0]["id"], 1);
+    CHECK_EQ(reply[0]["error"]["code"], -32600);
+    CHECK_EQ(reply[1]["id"], 2);
+    CHECK_EQ(reply[1]["error"]["code"], -32600);
+    CHECK(reply[2]["id"].is_null());
+    CHECK_EQ(reply[2]["error"]["code"], -32600);
+}
+
+// a batch with ids is answered even when no handler produced a response
+static void SilentBatchIsStillAnswered() {
+    auto written = Run(2, {R"([{"jsonrpc":"2.0","id":4,"method":"notifications/initialized"}])"});
+    if (!CHECK_EQ(written.size(), 1u)) return;
+    const json& reply = written[0];
+    if (!CHECK(reply.is_array() && reply.size() == 1)) return;
+    CHECK_EQ(reply[0]["id"], 4);
+    CHECK_EQ(reply[0]["error"]["code"], -32603);
+}
+
+static void EveryRequestIsAnswered(int workers) {
+    std::vector<std::string> messages;
+    for (int i = 0; i < 200; i++) {
+        messages.push_back(R"({"jsonrpc":"2.0","id":)" + std::to_string(i) + R"(,"method":"ping"})");
+    }
+    auto written = Run(workers, messages);
+    if (!CHECK_EQ(written.size(), 200u)) return;
+    std::vector<bool> answered(200, false);
+    for (const auto& response : written) answered[response["id"].get<int>()] = true;
+    CHECK(std::all_of(answered.begin(), answered.end(), [](bool seen) { return seen; }));
+    if (workers == 0) {
+        bool ordered = true;
+        for (int i = 0; i < 200; i++) ordered = ordered && written[i]["id"] == i;
+        CHECK(ordered);
+    }
+}
+
+// a response completed by another thread after the client went away still goes out
+static void DeferredResponsesAreWaitedFor() {
+    std::vector<std::thread> completions;
+    auto written = Run(2, {R"({"jsonrpc":"2.0","id":7,"method":"tools/call"})"}, [&completions](vx::mcp::Server& server) {
+        server.OverrideRawCallback("tools/call", [&server, &completions](const json& request, std::string_view) {
+            auto deferred = server.DeferResponse();
+            completions.emplace_back([deferred, id = request["id"]]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                deferred.Complete(json({{"jsonrpc", "2.0"}, {"id", id}, {"result", json::object()}}).dump());
+            });
+            return deferred.Await();
+        });
+    });
+    for (auto& thread : completions) thread.join();
+    if (!CHECK_EQ(written.size(), 1u)) return;
+    CHECK_EQ(written[0]["id"], 7);
+    CHECK(written[0].contains("result"));
+}
+
+// a handler failing after part of its result went out gets the response cut off, not completed
+static void FailedStreamIsCutOff() {
+    vx::mcp::Server server;
+    server.Workers(2);
+    server.OverrideRawCallback("tools/call", [&server](const json& request, std::string_view) {
+        auto stream = server.OpenResponseStream();
+        std::string piece(RESPONSE_STREAM_CHUNK, ' ');
+        stream.Write(R"({"content":[)");
+        stream.Write(piece);
+        return stream.Abort(json({{"jsonrpc", "2.0"}, {"id", request["id"]}, {"error", {{"code", -32603}}}}).dump());
+    });
+    auto transport = std::make_shared<StreamingTransport>(std::vector<std::string> {
+            R"({"jsonrpc":"2.0","id":5,"method":"tools/call"})"});
+    server.Connect(transport);
+
+    CHECK(transport->aborted);
+    CHECK(!transport->closed);
+    CHECK(transport->Written().empty());
+    CHECK(!json::accept(transport->streamed));
+}
+
+// while none of the result went out, the client gets the error in its place
+static void FailedStreamAnswersTheError() {
+    vx::mcp::Server server;
+    server.Workers(2);
+    server.OverrideRawCallback("tools/call", [&server](const json& request, std::string_view) {
+        auto stream = server.OpenResponseStream();
+        stream.Write(R"({"content":[)");
+        return stream.Abort(json({{"jsonrpc", "2.0"}, {"id", request["id"]}, {"error", {{"code", -32603}}}}).dump());
+    });
+    auto transport = std::make_shared<StreamingTransport>(std::vector<std::string> {
+            R"({"jsonrpc":"2.0","id":6,"method":"tools/call"})"});
+    server.Connect(transport);
+
+    CHECK(transport->closed);
+    CHECK(!transport->aborted);
+    if (!CHECK(json::accept(transport->streamed))) return;
+    json response = json::parse(transport->streamed);
+    CHECK_EQ(response["id"], 6);
+    CHECK_EQ(response["error"]["code"], -32603);
+}
+
+int main() {
+    AixLog::Log::init<AixLog::SinkNull>(); // quiet: the server logs every step
+    BatchRepliesInRequestOrder(4);
+    BatchRepliesInRequestOrder(0);
+    BatchOfNotificationsIsNotAnswered();
+    EmptyBatchIsAnError();
+    MalformedNotificationsAreNotAnswered();
+    MalformedRequestsAreErrors();
+    SilentBatchIsStillAnswered();
+    EveryRequestIsAnswered(4);
+    EveryRequestIsAnswered(0);
+    DeferredResponsesAreWaitedFor();
+    FailedStreamIsCutOff();
+    FailedStreamAnswersTheError();
+    return vx::test::Report("ServerBatch");
+}
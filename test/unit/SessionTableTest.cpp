@@ -0,0 +1,85 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <string>
+#include <vector>
+#include "Check.h"
+#include "utils/SessionTable.h"
+
+struct TestSession {
+    std::string id;
+    uint64_t token = 0;
+    int value = 0;
+};
+
+static void SessionsAreFoundByTokenAndId() {
+    vx::utils::SessionTable<TestSession> sessions;
+    auto first = sessions.Create();
+    auto second = sessions.Create();
+    CHECK(first->token != 0);
+    CHECK(first->token != second->token);
+    CHECK(first->id != second->id);
+    CHECK_EQ(sessions.Size(), 2u);
+
+    CHECK_EQ(sessions.Find(first->token), first);
+    CHECK_EQ(sessions.Find(std::string_view(second->id)), second);
+    CHECK_EQ(sessions.Find(uint64_t(0)), nullptr);
+    CHECK_EQ(sessions.Find(std::string_view("unknown")), nullptr);
+
+    // an id carrying a valid token but not the one that was handed out is not a session
+    std::string forged = "x" + first->id;
+    CHECK_EQ(sessions.Find(std::string_view(forged)), nullptr);
+}
+
+static void SessionsAreRemoved() {
+    vx::utils::SessionTable<TestSession> sessions;
+    std::vector<std::shared_ptr<TestSession>> created;
+    for (int i = 0; i < 40; i++) {
+        created.push_back(sessions.Create());
+        created.back()->value = i;
+    }
+
+    CHECK(sessions.Remove(created[0]->token));
+    CHECK(!sessions.Remove(created[0]->token));
+    CHECK_EQ(sessions.Size(), 39u);
+
+    auto removed = sessions.RemoveIf([](const TestSession& session) { return session.value % 2 == 1; });
+    CHECK_EQ(removed.size(), 20u);
+    CHECK_EQ(sessions.Size(), 19u);
+
+    int visited = 0;
+    bool allEven = true;
+    sessions.ForEach([&](const std::shared_ptr<TestSession>& session) {
+        visited++;
+        allEven = allEven && session->value % 2 == 0;
+    });
+    CHECK_EQ(visited, 19);
+    CHECK(allEven);
+}
+
+int main() {
+    SessionsAreFoundByTokenAndId();
+    SessionsAreRemoved();
+    return vx::test::Report("SessionTable");
+}
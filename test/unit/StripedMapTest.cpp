@@ -0,0 +1,81 @@
+//  The MIT License
+//
+//  Copyright (C) 2025 Giuseppe Mastrangelo
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  'Software'), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <string>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include "Check.h"
+#include "utils/StripedMap.h"
+
+static void StripedMapTakesEntriesOnce() {
+    vx::utils::StripedMap<int, std::string> map;
+    CHECK(map.Insert(1, "one"));
+    CHECK(!map.Insert(1, "uno"));
+
+    bool seen = map.Visit(1, [](std::string& value) { value += "!"; });
+    CHECK(seen);
+    CHECK(!map.TakeIf(1, [](const std::string& value) { return value.empty(); }));
+
+    auto taken = map.Take(1);
+    CHECK(taken.has_value() && *taken == "one!");
+    CHECK(!map.Take(1));
+
+    // recycled nodes do not carry anything over
+    CHECK(map.Insert(2, "two"));
+    CHECK(map.Insert(1, "again"));
+    auto again = map.Take(1);
+    CHECK(again.has_value() && *again == "again");
+
+    for (int i = 10; i < 20; i++) map.Insert(i, std::to_string(i));
+    auto removed = map.RemoveIf([](int key, const std::string&) { return key >= 15; });
+    CHECK_EQ(removed.size(), 5u);
+    CHECK(map.Take(14).has_value());
+    CHECK(!map.Take(15).has_value());
+}
+
+static void StripedMapUnderContention() {
+    vx::utils::StripedMap<uint64_t, uint64_t> map;
+    std::atomic<int> lost {0};
+    std::vector<std::thread> threads;
+    for (uint64_t t = 0; t < 8; t++) {
+        threads.emplace_back([&map, &lost, t]() {
+            for (uint64_t i = 0; i < 20000; i++) {
+                uint64_t key = (t << 32) | i;
+                if (!map.Insert(key, i)) lost++;
+                auto value = map.Take(key);
+                if (!value || *value != i) lost++;
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    CHECK_EQ(lost.load(), 0);
+}
+
+int main() {
+    StripedMapTakesEntriesOnce();
+    StripedMapUnderContention();
+    return vx::test::Report("StripedMap");
+}